@@ -0,0 +1,173 @@
+#pragma once
+
+// ==========================================
+// benchmark 公共部分: 参数解析、绑核、延迟直方图、结果输出
+// ==========================================
+// 所有 benchmark 的结果以一行 JSON 输出到 stdout，便于脚本比较不同版本；过程信息输出到 stderr。
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "socket.h"
+
+inline int64_t bench_now_ns() { return clock_now_ns<ClockSource::Monotonic>(); }
+
+// --name=value 形式的命令行参数
+class BenchArgs {
+   public:
+    BenchArgs(int argc, char** argv) : argc_(argc), argv_(argv) {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--help") == 0 || strncmp(argv[i], "--", 2) != 0) help_ = true;
+        }
+    }
+
+    bool help() const { return help_; }
+
+    const char* get(const char* name, const char* def) const {
+        size_t len = strlen(name);
+        for (int i = 1; i < argc_; i++) {
+            const char* a = argv_[i];
+            if (strncmp(a, "--", 2) == 0 && strncmp(a + 2, name, len) == 0 && a[2 + len] == '=') return a + 3 + len;
+        }
+        return def;
+    }
+
+    int64_t getInt(const char* name, int64_t def) const {
+        const char* v = get(name, nullptr);
+        return v ? strtoll(v, nullptr, 10) : def;
+    }
+
+    // 逗号分隔的整数列表，返回个数
+    uint32_t getList(const char* name, const char* def, int64_t* out, uint32_t max_cnt) const {
+        const char* v = get(name, def);
+        uint32_t n = 0;
+        while (*v && n < max_cnt) {
+            char* end;
+            out[n++] = strtoll(v, &end, 10);
+            v = *end == ',' ? end + 1 : end;
+            if (end == v && *v) break;
+        }
+        return n;
+    }
+
+   private:
+    int argc_;
+    char** argv_;
+    bool help_ = false;
+};
+
+// cpu < 0 时不绑核
+inline void bench_pin_cpu(int64_t cpu) {
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) fprintf(stderr, "pin to cpu %ld failed\n", cpu);
+}
+
+// --yield=1 时每次 poll 之后让出 CPU，在核数少于线程数的机器上 (如 CI) 也能跑完，但延迟数据不再有代表性
+inline void bench_relax(bool yield) {
+    if (yield) sched_yield();
+}
+
+inline void bench_raise_nofile(uint64_t want) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur >= want) return;
+    rl.rlim_cur = std::min<uint64_t>(want, rl.rlim_max);
+    setrlimit(RLIMIT_NOFILE, &rl);
+}
+
+// HdrHistogram 式的对数-线性分桶: 每个 2 的幂区间再分 SubBuckets/2 个等宽桶，相对误差 < 2/SubBuckets (< 1%)
+class LatencyHistogram {
+   public:
+    static constexpr uint32_t SubBucketBits = 8;
+    static constexpr uint32_t SubBuckets = 1u << SubBucketBits;
+    static constexpr uint32_t Buckets = 64 - SubBucketBits + 1;
+
+    void record(int64_t v) {
+        if (v < 0) v = 0;
+        counts_[index(v)]++;
+        cnt_++;
+        sum_ += v;
+        if (v > max_) max_ = v;
+    }
+
+    uint64_t count() const { return cnt_; }
+    int64_t max() const { return max_; }
+    double mean() const { return cnt_ ? static_cast<double>(sum_) / cnt_ : 0; }
+
+    // q 取 [0, 1]，返回所在桶的上界
+    int64_t percentile(double q) const {
+        if (!cnt_) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * cnt_));
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < Buckets * SubBuckets; i++) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(upper(i), max_);
+        }
+        return max_;
+    }
+
+   private:
+    static uint32_t index(int64_t v) {
+        uint64_t u = static_cast<uint64_t>(v);
+        if (u < SubBuckets) return u;
+        uint32_t bucket = 64 - std::countl_zero(u) - SubBucketBits;
+        uint32_t sub = static_cast<uint32_t>(u >> bucket) & (SubBuckets - 1);
+        return bucket * SubBuckets + sub;
+    }
+
+    static int64_t upper(uint32_t i) {
+        uint32_t bucket = i / SubBuckets;
+        uint64_t sub = i % SubBuckets;
+        if (bucket == 0) return sub;
+        return static_cast<int64_t>(((sub + 1) << bucket) - 1);
+    }
+
+    uint64_t counts_[Buckets * SubBuckets] = {};
+    uint64_t cnt_ = 0;
+    int64_t sum_ = 0;
+    int64_t max_ = 0;
+};
+
+// 一个 BenchJson 对象输出一行 JSON，析构时结束该行
+class BenchJson {
+   public:
+    explicit BenchJson(const char* bench) { printf("{\"bench\":\"%s\"", bench); }
+    ~BenchJson() {
+        printf("}\n");
+        fflush(stdout);
+    }
+
+    BenchJson& str(const char* key, const char* v) {
+        printf(",\"%s\":\"%s\"", key, v);
+        return *this;
+    }
+    BenchJson& num(const char* key, int64_t v) {
+        printf(",\"%s\":%ld", key, static_cast<long>(v));
+        return *this;
+    }
+    BenchJson& num(const char* key, double v) {
+        printf(",\"%s\":%.6g", key, v);
+        return *this;
+    }
+
+    BenchJson& latency(const LatencyHistogram& h) {
+        num("samples", static_cast<int64_t>(h.count()));
+        num("mean_ns", h.mean());
+        num("p50_ns", h.percentile(0.5));
+        num("p99_ns", h.percentile(0.99));
+        num("p999_ns", h.percentile(0.999));
+        num("max_ns", h.max());
+        return *this;
+    }
+};
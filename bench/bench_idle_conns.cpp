@@ -0,0 +1,179 @@
+// 大量空闲连接下的延迟: 依次建立 --conns 中给定数量的空闲连接，每一档用一个活跃连接测 ping-pong RTT，
+// 用于比较不同后端的延迟随连接数的变化 (Scan 逐连接轮询，epoll/io_uring 只处理就绪连接)。
+// 建立空闲连接时最多 --window 个连接在等待服务端 accept，模拟大量客户端同时重连，同时输出服务端的 accept 速率。
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "bench_common.h"
+
+static const uint32_t MaxIdleConns = 16384;
+
+template <PollBackend B>
+struct ServerConf {
+    static const uint32_t RecvBufSize = 1024;
+    static const uint32_t MaxConns = MaxIdleConns + 1;
+    static constexpr PollBackend Backend = B;
+    struct UserData {};
+};
+
+struct ClientConf {
+    static const uint32_t RecvBufSize = 1024;
+    static const uint32_t ConnTimeoutSec = 3;
+    struct UserData {};
+};
+
+template <PollBackend B>
+class EchoServer : public SocketTcpServer<ServerConf<B>> {
+   public:
+    using Conn = typename SocketTcpServer<ServerConf<B>>::Conn;
+    std::atomic<uint32_t> conns{0};
+
+    void onTcpConnected(Conn&) { conns.fetch_add(1, std::memory_order_relaxed); }
+    void onSendTimeout(Conn&) {}
+    void onRecvTimeout(Conn&) {}
+    void onTcpDisconnect(Conn&) { conns.fetch_sub(1, std::memory_order_relaxed); }
+    uint32_t onTcpData(Conn& conn, const uint8_t* data, uint32_t size) {
+        conn.write(data, size);
+        return 0;
+    }
+};
+
+class PingClient : public SocketTcpClient<ClientConf> {
+   public:
+    uint32_t pending = 0;
+    bool connected = false;
+
+    void onTcpConnectFailed() {}
+    void onTcpConnected(Conn&) { connected = true; }
+    void onTcpDisconnect(Conn&) { connected = false; }
+    void onSendTimeout(Conn&) {}
+    void onRecvTimeout(Conn&) {}
+    uint32_t onTcpData(Conn&, const uint8_t*, uint32_t size) {
+        pending -= std::min(pending, size);
+        return 0;
+    }
+};
+
+template <PollBackend B>
+static int run(const BenchArgs& args, const char* backend_name) {
+    uint32_t size = args.getInt("size", 64);
+    int64_t count = args.getInt("count", 20000);
+    uint16_t port = args.getInt("port", 23480);
+    bool yield = args.getInt("yield", 0);
+    uint32_t window = std::max<int64_t>(args.getInt("window", 256), 1);
+    int64_t levels[32];
+    uint32_t level_cnt = args.getList("conns", "0,100,1000,10000", levels, 32);
+    if (size == 0 || size > ClientConf::RecvBufSize) {
+        fprintf(stderr, "size must be in [1, %u]\n", ClientConf::RecvBufSize);
+        return 1;
+    }
+    bench_raise_nofile(2 * MaxIdleConns + 64);
+
+    auto server = std::make_unique<EchoServer<B>>();
+    if (!server->init("", "127.0.0.1", port)) {
+        fprintf(stderr, "server init failed: %s\n", server->getLastError());
+        return 1;
+    }
+    std::atomic<bool> running{true};
+    std::thread server_thread([&] {
+        bench_pin_cpu(args.getInt("server-cpu", -1));
+        while (running.load(std::memory_order_relaxed)) {
+            server->poll(*server);
+            bench_relax(yield);
+        }
+    });
+    bench_pin_cpu(args.getInt("client-cpu", -1));
+
+    auto client = std::make_unique<PingClient>();
+    client->init("", "127.0.0.1", port);
+    int64_t deadline = bench_now_ns() + 3000000000LL;
+    while (!client->connected && bench_now_ns() < deadline) {
+        client->poll(*client);
+        bench_relax(yield);
+    }
+
+    auto idle_fds = std::make_unique<int[]>(MaxIdleConns);
+    uint32_t idle_cnt = 0;
+    auto msg = std::make_unique<uint8_t[]>(size);
+    memset(msg.get(), 'x', size);
+    int ret = client->connected ? 0 : 1;
+    for (uint32_t l = 0; l < level_cnt && ret == 0; l++) {
+        uint32_t target = std::min<int64_t>(levels[l], MaxIdleConns);
+        uint32_t accept_from = idle_cnt;
+        int64_t accept_start = bench_now_ns();
+        // loopback 上的阻塞 connect 在握手完成 (进入服务端 accept 队列) 时就返回；
+        // 未 accept 的连接超过监听 backlog 时 SYN 会被丢弃并退避重传，所以等待 accept 的连接最多 window 个
+        while (idle_cnt < target) {
+            deadline = bench_now_ns() + 10000000000LL;
+            while (idle_cnt + 1 - server->conns.load(std::memory_order_relaxed) >= window && bench_now_ns() < deadline)
+                bench_relax(true);
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            struct sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+                fprintf(stderr, "idle connect failed at %u: %s\n", idle_cnt, strerror(errno));
+                if (fd >= 0) ::close(fd);
+                ret = 1;
+                break;
+            }
+            idle_fds[idle_cnt++] = fd;
+        }
+        deadline = bench_now_ns() + 10000000000LL;
+        while (server->conns.load(std::memory_order_relaxed) < idle_cnt + 1 && bench_now_ns() < deadline)
+            bench_relax(true);
+        if (ret) break;
+        double accept_sec = (bench_now_ns() - accept_start) / 1e9;
+
+        auto hist = std::make_unique<LatencyHistogram>();
+        for (int64_t i = 0; i < count / 10 + count && client->connected; i++) {
+            client->pending = size;
+            int64_t start = bench_now_ns();
+            client->write(msg.get(), size);
+            while (client->pending && client->connected) {
+                client->poll(*client);
+                bench_relax(yield);
+            }
+            if (i >= count / 10) hist->record(bench_now_ns() - start);
+        }
+        if (!client->connected) {
+            fprintf(stderr, "disconnected: %s\n", client->getLastError());
+            ret = 1;
+            break;
+        }
+        BenchJson("idle_conns")
+            .str("backend", backend_name)
+            .num("idle_conns", static_cast<int64_t>(idle_cnt))
+            .num("size", static_cast<int64_t>(size))
+            .num("accepts_per_sec", idle_cnt > accept_from ? (idle_cnt - accept_from) / accept_sec : 0.0)
+            .latency(*hist);
+    }
+    running = false;
+    server_thread.join();
+    for (uint32_t i = 0; i < idle_cnt; i++) ::close(idle_fds[i]);
+    return ret;
+}
+
+int main(int argc, char** argv) {
+    BenchArgs args(argc, argv);
+    if (args.help()) {
+        fprintf(stderr,
+                "usage: %s [--backend=epoll|scan|epoll-et|uring] [--conns=0,100,1000,10000] [--size=64] "
+                "[--count=20000] [--window=256] [--server-cpu=-1] [--client-cpu=-1] [--port=23480] [--yield=0]\n",
+                argv[0]);
+        return 1;
+    }
+    const char* backend = args.get("backend", "epoll");
+    if (strcmp(backend, "scan") == 0) return run<PollBackend::Scan>(args, backend);
+    if (strcmp(backend, "epoll") == 0) return run<PollBackend::EpollLevel>(args, backend);
+    if (strcmp(backend, "epoll-et") == 0) return run<PollBackend::EpollEdge>(args, backend);
+    if (strcmp(backend, "uring") == 0) return run<PollBackend::IoUring>(args, backend);
+    fprintf(stderr, "unknown backend %s\n", backend);
+    return 1;
+}
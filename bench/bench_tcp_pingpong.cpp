@@ -0,0 +1,121 @@
+// TCP ping-pong RTT: 客户端发一条 size 字节的消息，服务端原样回显，收齐后记录一次往返时间。
+// 服务端与客户端各占一个线程，可分别绑核。
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "bench_common.h"
+
+struct ServerConf {
+    static const uint32_t RecvBufSize = 1 << 16;
+    static const uint32_t MaxConns = 4;
+    static constexpr PollBackend Backend = PollBackend::EpollLevel;
+    struct UserData {};
+};
+
+struct ClientConf {
+    static const uint32_t RecvBufSize = 1 << 16;
+    static const uint32_t ConnTimeoutSec = 3;
+    struct UserData {};
+};
+
+class EchoServer : public SocketTcpServer<ServerConf> {
+   public:
+    void onTcpConnected(Conn&) {}
+    void onSendTimeout(Conn&) {}
+    void onRecvTimeout(Conn&) {}
+    void onTcpDisconnect(Conn&) {}
+    uint32_t onTcpData(Conn& conn, const uint8_t* data, uint32_t size) {
+        conn.write(data, size);
+        return 0;
+    }
+};
+
+class PingClient : public SocketTcpClient<ClientConf> {
+   public:
+    uint32_t pending = 0;
+    bool connected = false;
+
+    void onTcpConnectFailed() {}
+    void onTcpConnected(Conn&) { connected = true; }
+    void onTcpDisconnect(Conn&) { connected = false; }
+    void onSendTimeout(Conn&) {}
+    void onRecvTimeout(Conn&) {}
+    uint32_t onTcpData(Conn&, const uint8_t*, uint32_t size) {
+        pending -= std::min(pending, size);
+        return 0;
+    }
+};
+
+int main(int argc, char** argv) {
+    BenchArgs args(argc, argv);
+    if (args.help()) {
+        fprintf(stderr,
+                "usage: %s [--size=64] [--count=100000] [--warmup=10000] [--server-cpu=-1] [--client-cpu=-1] "
+                "[--port=23456] [--yield=0]\n",
+                argv[0]);
+        return 1;
+    }
+    uint32_t size = args.getInt("size", 64);
+    int64_t count = args.getInt("count", 100000);
+    int64_t warmup = args.getInt("warmup", 10000);
+    uint16_t port = args.getInt("port", 23456);
+    bool yield = args.getInt("yield", 0);
+    if (size == 0 || size > ClientConf::RecvBufSize) {
+        fprintf(stderr, "size must be in [1, %u]\n", ClientConf::RecvBufSize);
+        return 1;
+    }
+
+    auto server = std::make_unique<EchoServer>();
+    if (!server->init("", "127.0.0.1", port)) {
+        fprintf(stderr, "server init failed: %s\n", server->getLastError());
+        return 1;
+    }
+    std::atomic<bool> running{true};
+    std::thread server_thread([&] {
+        bench_pin_cpu(args.getInt("server-cpu", -1));
+        while (running.load(std::memory_order_relaxed)) {
+            server->poll(*server);
+            bench_relax(yield);
+        }
+    });
+
+    bench_pin_cpu(args.getInt("client-cpu", -1));
+    auto client = std::make_unique<PingClient>();
+    client->init("", "127.0.0.1", port);
+    int64_t deadline = bench_now_ns() + 3000000000LL;
+    while (!client->connected && bench_now_ns() < deadline) {
+        client->poll(*client);
+        bench_relax(yield);
+    }
+    if (!client->connected) {
+        fprintf(stderr, "connect failed: %s\n", client->getLastError());
+        running = false;
+        server_thread.join();
+        return 1;
+    }
+
+    auto msg = std::make_unique<uint8_t[]>(size);
+    memset(msg.get(), 'x', size);
+    auto hist = std::make_unique<LatencyHistogram>();
+    for (int64_t i = 0; i < warmup + count && client->connected; i++) {
+        client->pending = size;
+        int64_t start = bench_now_ns();
+        client->write(msg.get(), size);
+        while (client->pending && client->connected) {
+            client->poll(*client);
+            bench_relax(yield);
+        }
+        if (i >= warmup) hist->record(bench_now_ns() - start);
+    }
+    running = false;
+    server_thread.join();
+    if (!client->connected) {
+        fprintf(stderr, "disconnected: %s\n", client->getLastError());
+        return 1;
+    }
+
+    BenchJson("tcp_pingpong").num("size", static_cast<int64_t>(size)).latency(*hist);
+    return 0;
+}
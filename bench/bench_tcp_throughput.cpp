@@ -0,0 +1,145 @@
+// TCP 单向流吞吐: 客户端在 duration 内尽快发送带 4 字节长度头的消息，服务端解帧计数，
+// 对 --sizes 中的每种消息大小各输出一行 msgs/s 与 GB/s。
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "bench_common.h"
+
+struct ServerConf {
+    static const uint32_t RecvBufSize = 1 << 20;
+    static const uint32_t MaxConns = 4;
+    static constexpr PollBackend Backend = PollBackend::EpollLevel;
+    struct UserData {};
+};
+
+struct ClientConf {
+    static const uint32_t RecvBufSize = 4096;
+    static const uint32_t ConnTimeoutSec = 3;
+    struct UserData {};
+};
+
+class SinkServer : public SocketTcpServer<ServerConf> {
+   public:
+    std::atomic<uint64_t> msgs{0};
+    std::atomic<uint64_t> bytes{0};
+
+    void onTcpConnected(Conn&) {}
+    void onSendTimeout(Conn&) {}
+    void onRecvTimeout(Conn&) {}
+    void onTcpDisconnect(Conn&) {}
+    uint32_t onTcpData(Conn&, const uint8_t* data, uint32_t size) {
+        uint64_t n = 0, b = 0;
+        while (size >= 4) {
+            uint32_t len;
+            memcpy(&len, data, 4);
+            if (size < 4 + len) break;
+            n++;
+            b += len;
+            data += 4 + len;
+            size -= 4 + len;
+        }
+        msgs.store(msgs.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        bytes.store(bytes.load(std::memory_order_relaxed) + b, std::memory_order_relaxed);
+        return size;
+    }
+};
+
+class StreamClient : public SocketTcpClient<ClientConf> {
+   public:
+    bool connected = false;
+
+    void onTcpConnectFailed() {}
+    void onTcpConnected(Conn&) { connected = true; }
+    void onTcpDisconnect(Conn&) { connected = false; }
+    void onSendTimeout(Conn&) {}
+    void onRecvTimeout(Conn&) {}
+    uint32_t onTcpData(Conn&, const uint8_t*, uint32_t) { return 0; }
+};
+
+static bool run(const BenchArgs& args, uint32_t size, uint16_t port) {
+    int64_t duration_ns = args.getInt("duration-ms", 1000) * 1000000;
+    bool yield = args.getInt("yield", 0);
+    auto server = std::make_unique<SinkServer>();
+    if (!server->init("", "127.0.0.1", port)) {
+        fprintf(stderr, "server init failed: %s\n", server->getLastError());
+        return false;
+    }
+    std::atomic<bool> running{true};
+    std::thread server_thread([&] {
+        bench_pin_cpu(args.getInt("server-cpu", -1));
+        while (running.load(std::memory_order_relaxed)) {
+            server->poll(*server);
+            bench_relax(yield);
+        }
+    });
+
+    auto client = std::make_unique<StreamClient>();
+    client->init("", "127.0.0.1", port);
+    int64_t deadline = bench_now_ns() + 3000000000LL;
+    while (!client->connected && bench_now_ns() < deadline) {
+        client->poll(*client);
+        bench_relax(yield);
+    }
+
+    auto msg = std::make_unique<uint8_t[]>(4 + size);
+    memcpy(msg.get(), &size, 4);
+    memset(msg.get() + 4, 'x', size);
+    uint64_t sent = 0;
+    int64_t start = bench_now_ns();
+    while (client->connected && bench_now_ns() - start < duration_ns) {
+        if (!client->write(msg.get(), 4 + size)) break;
+        sent++;
+        if ((sent & 63) == 0) {
+            client->poll(*client);
+            bench_relax(yield);
+        }
+    }
+    deadline = bench_now_ns() + 5000000000LL;
+    while (server->msgs.load(std::memory_order_relaxed) < sent && bench_now_ns() < deadline) {
+        client->poll(*client);
+        bench_relax(yield);
+    }
+    int64_t elapsed = bench_now_ns() - start;
+    running = false;
+    server_thread.join();
+
+    uint64_t msgs = server->msgs.load();
+    if (msgs < sent) {
+        fprintf(stderr, "size %u: received %lu of %lu msgs: %s\n", size, msgs, sent, client->getLastError());
+        return false;
+    }
+    double sec = elapsed / 1e9;
+    BenchJson("tcp_throughput")
+        .num("size", static_cast<int64_t>(size))
+        .num("msgs", static_cast<int64_t>(msgs))
+        .num("elapsed_ns", elapsed)
+        .num("msgs_per_sec", msgs / sec)
+        .num("gbytes_per_sec", server->bytes.load() / sec / 1e9);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchArgs args(argc, argv);
+    if (args.help()) {
+        fprintf(stderr,
+                "usage: %s [--sizes=64,256,1024,4096,16384,65536] [--duration-ms=1000] [--server-cpu=-1] "
+                "[--client-cpu=-1] [--port=23457] [--yield=0]\n",
+                argv[0]);
+        return 1;
+    }
+    int64_t sizes[32];
+    uint32_t n = args.getList("sizes", "64,256,1024,4096,16384,65536", sizes, 32);
+    uint16_t port = args.getInt("port", 23457);
+    bench_pin_cpu(args.getInt("client-cpu", -1));
+    for (uint32_t i = 0; i < n; i++) {
+        if (sizes[i] <= 0 || sizes[i] + 4 > ServerConf::RecvBufSize) {
+            fprintf(stderr, "size must be in [1, %u]\n", ServerConf::RecvBufSize - 4);
+            return 1;
+        }
+        // 每种大小使用新的端口，避免上一轮的 TIME_WAIT 影响
+        if (!run(args, sizes[i], port + i)) return 1;
+    }
+    return 0;
+}
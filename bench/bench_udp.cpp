@@ -0,0 +1,105 @@
+// UDP 包速率与丢包: 发送线程按 --rate (0 为不限速) 发出 --count 个带序号的数据报，
+// 接收端用 recvmmsg 批量接收，统计收到的数量、序号不连续的次数以及接收速率。
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "bench_common.h"
+
+using Receiver = SocketUdpReceiver<2048, PollBackend::Scan, 32>;
+using BatchSender = SocketUdpBatchSender<64, 2048>;
+
+int main(int argc, char** argv) {
+    BenchArgs args(argc, argv);
+    if (args.help()) {
+        fprintf(stderr,
+                "usage: %s [--size=64] [--count=1000000] [--rate=0] [--batch=1] [--sender-cpu=-1] "
+                "[--receiver-cpu=-1] [--port=23470] [--yield=0]\n",
+                argv[0]);
+        return 1;
+    }
+    uint32_t size = args.getInt("size", 64);
+    int64_t count = args.getInt("count", 1000000);
+    int64_t rate = args.getInt("rate", 0);
+    uint32_t batch = args.getInt("batch", 1);
+    uint16_t port = args.getInt("port", 23470);
+    bool yield = args.getInt("yield", 0);
+    if (size < 8 || size > 2048 || batch == 0 || batch > 64) {
+        fprintf(stderr, "size must be in [8, 2048], batch in [1, 64]\n");
+        return 1;
+    }
+
+    auto receiver = std::make_unique<Receiver>();
+    if (!receiver->init("", "127.0.0.1", port)) {
+        fprintf(stderr, "receiver init failed: %s\n", receiver->getLastError());
+        return 1;
+    }
+    auto sender = std::make_unique<BatchSender>();
+    if (!sender->init("", "127.0.0.1", 0, "127.0.0.1", port)) {
+        fprintf(stderr, "sender init failed: %s\n", sender->getLastError());
+        return 1;
+    }
+
+    std::atomic<bool> sender_done{false};
+    std::thread sender_thread([&] {
+        bench_pin_cpu(args.getInt("sender-cpu", -1));
+        auto msg = std::make_unique<uint8_t[]>(size);
+        memset(msg.get(), 'x', size);
+        int64_t start = bench_now_ns();
+        for (int64_t seq = 0; seq < count; seq++) {
+            // 限速时按序号计算应发时间，忙等到点再发
+            if (rate > 0) {
+                int64_t due = start + seq * 1000000000LL / rate;
+                while (bench_now_ns() < due) bench_relax(yield);
+            }
+            memcpy(msg.get(), &seq, 8);
+            if (batch == 1) {
+                sender->write(msg.get(), size);
+            } else {
+                sender->queue(msg.get(), size);
+                if (sender->getQueuedCnt() >= batch) sender->flush();
+            }
+            if (yield && (seq & 63) == 0) bench_relax(yield);
+        }
+        while (sender->getQueuedCnt() && sender->flush() >= 0) bench_relax(yield);
+        sender_done = true;
+    });
+
+    bench_pin_cpu(args.getInt("receiver-cpu", -1));
+    int64_t received = 0, seq_gaps = 0, next_seq = 0;
+    int64_t first_ns = 0, last_ns = 0, idle_since = 0;
+    while (true) {
+        bool got = receiver->read([&](const uint8_t* data, uint32_t) {
+            int64_t seq;
+            memcpy(&seq, data, 8);
+            if (seq != next_seq) seq_gaps++;
+            next_seq = seq + 1;
+            received++;
+        });
+        int64_t now = bench_now_ns();
+        if (got) {
+            if (!first_ns) first_ns = now;
+            last_ns = now;
+            idle_since = 0;
+        } else if (sender_done.load(std::memory_order_relaxed)) {
+            // 发送结束后 200ms 没有新数据即认为剩下的都丢了
+            if (!idle_since) idle_since = now;
+            if (received == count || now - idle_since > 200000000) break;
+        }
+        bench_relax(yield);
+    }
+    sender_thread.join();
+
+    double sec = (last_ns - first_ns) / 1e9;
+    BenchJson("udp")
+        .num("size", static_cast<int64_t>(size))
+        .num("batch", static_cast<int64_t>(batch))
+        .num("rate", rate)
+        .num("sent", count)
+        .num("received", received)
+        .num("loss", count ? 1.0 - static_cast<double>(received) / count : 0.0)
+        .num("seq_gaps", seq_gaps)
+        .num("pkts_per_sec", sec > 0 ? received / sec : 0.0);
+    return 0;
+}
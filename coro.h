@@ -0,0 +1,382 @@
+#pragma once
+
+// ==========================================
+// C++20 协程接口 (Coroutine)
+// ==========================================
+// 把一个连接上多步的会话写成顺序代码，仍由原来的 poll 循环驱动，不为连接开线程:
+//   struct Conf { ... struct UserData : CoroConnState {}; };
+//   class MyServer : public SocketTcpServer<Conf>, public CoroHandler<MyServer> {
+//       CoroTask<> onTcpSession(Conn& conn) {           // 连接建立时启动
+//           while (true) {
+//               auto hdr = co_await readExact(conn, 4);  // 空 span 表示连接已断开
+//               if (hdr.empty()) co_return;
+//               ...
+//               if (!co_await writeAll(conn, rsp, len)) co_return;
+//           }
+//       }
+//   };
+// CoroHandler 实现 onTcpConnected/onTcpData/onTcpDisconnect/onSendDrained 等回调并在其中恢复等待的协程，
+// 派生类自己定义这些回调时需要转调 CoroHandler 的版本。每个连接同一时刻只能有一个协程在等待。
+// readExact 返回的数据直接指向接收缓冲，只在下一次 co_await 之前有效，需要保留的要先拷贝；
+// 单次最多读 RecvBufSize 字节 (Spill 模式下为 SpillBufSize)，更大的读取会因接收缓冲满断开连接。
+// writeAll 把数据写入发送队列，放不下时挂起到队列发完再继续，挂起期间 data 必须有效。
+// 协程帧从线程局部的分级空闲链表分配 (CoroFramePool)，稳定运行后创建协程不再 malloc；awaiter 位于协程帧内，co_await 不分配内存。
+// server/client 析构时不会恢复仍在等待的协程，退出前应先关闭连接并 poll 到 onTcpDisconnect，让会话结束并释放帧。
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "socket.h"
+
+// 协程帧分配器: 按 64 字节向上取整分级，每级一个线程局部的空闲链表，释放的帧留给本线程之后的协程复用，线程退出时归还；
+// 超过 4KB 的帧直接使用 operator new
+class CoroFramePool {
+    static constexpr size_t Granularity = 64;
+    static constexpr size_t ClassCnt = 64;
+
+   public:
+    static void* alloc(size_t size) {
+        size_t cls = (size + Granularity - 1) / Granularity;
+        if (cls >= ClassCnt) return ::operator new(size);
+        FreeNode*& head = lists().heads[cls];
+        if (FreeNode* node = head) {
+            head = node->next;
+            return node;
+        }
+        return ::operator new(cls * Granularity);
+    }
+
+    static void release(void* p, size_t size) {
+        size_t cls = (size + Granularity - 1) / Granularity;
+        if (cls >= ClassCnt) {
+            ::operator delete(p);
+            return;
+        }
+        FreeNode*& head = lists().heads[cls];
+        head = new (p) FreeNode{head};
+    }
+
+   private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct FreeLists {
+        FreeNode* heads[ClassCnt] = {};
+
+        ~FreeLists() {
+            for (FreeNode* head : heads) {
+                while (head) ::operator delete(std::exchange(head, head->next));
+            }
+        }
+    };
+
+    static FreeLists& lists() {
+        thread_local FreeLists lists;
+        return lists;
+    }
+};
+
+template <typename T = void>
+class CoroTask;
+
+struct CoroPromiseBase {
+    std::coroutine_handle<> continuation;
+    bool detached = false;
+
+    static void* operator new(size_t size) { return CoroFramePool::alloc(size); }
+    static void operator delete(void* p, size_t size) { CoroFramePool::release(p, size); }
+
+    // 创建时不执行，被 co_await 或 detach 时才开始
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // 结束时直接切换回 co_await 它的协程 (对称转移，不增加栈深度)；detach 的协程自行释放帧
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            CoroPromiseBase& promise = h.promise();
+            if (promise.detached) {
+                h.destroy();
+                return std::noop_coroutine();
+            }
+            return promise.continuation ? promise.continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    // 库本身不使用异常，协程中逃出的异常没有地方报告
+    void unhandled_exception() { std::terminate(); }
+};
+
+template <typename T>
+struct CoroPromise : CoroPromiseBase {
+    std::optional<T> value;
+
+    CoroTask<T> get_return_object() { return CoroTask<T>(std::coroutine_handle<CoroPromise>::from_promise(*this)); }
+
+    template <typename U>
+    void return_value(U&& v) {
+        value.emplace(std::forward<U>(v));
+    }
+};
+
+template <>
+struct CoroPromise<void> : CoroPromiseBase {
+    CoroTask<void> get_return_object();
+
+    void return_void() {}
+};
+
+// 协程的返回类型: co_await 子协程得到它的返回值；detach 让协程独立运行 (如每个连接的会话)
+template <typename T>
+class [[nodiscard]] CoroTask {
+   public:
+    using promise_type = CoroPromise<T>;
+
+    explicit CoroTask(std::coroutine_handle<promise_type> h) : h_(h) {}
+    CoroTask(CoroTask&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+    CoroTask& operator=(CoroTask&&) = delete;
+
+    ~CoroTask() {
+        if (h_) h_.destroy();
+    }
+
+    // 开始执行，直到第一次挂起时返回，结束时自行释放帧 (返回值被丢弃)
+    void detach() && {
+        std::coroutine_handle<promise_type> h = std::exchange(h_, {});
+        h.promise().detached = true;
+        h.resume();
+    }
+
+    bool await_ready() { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) {
+        h_.promise().continuation = caller;
+        return h_;
+    }
+
+    T await_resume() {
+        if constexpr (!std::is_void_v<T>) return std::move(*h_.promise().value);
+    }
+
+   private:
+    std::coroutine_handle<promise_type> h_;
+};
+
+inline CoroTask<void> CoroPromise<void>::get_return_object() {
+    return CoroTask<void>(std::coroutine_handle<CoroPromise>::from_promise(*this));
+}
+
+enum class CoroWait : uint8_t { None, Read, Write, Timer, Connect };
+
+// 连接上等待中的协程，Conf::UserData 需要继承它；成员以 coro_ 开头，避免与 UserData 自己的成员重名
+struct CoroConnState {
+    std::coroutine_handle<> coro_waiter;
+    CoroWait coro_wait = CoroWait::None;
+    // Timer 恢复时的结果
+    bool coro_ok = false;
+    // Read: 要读的字节数 / 读到的数据 (断开时为 nullptr)；Write: 还没写入的数据
+    uint32_t coro_size = 0;
+    const uint8_t* coro_data = nullptr;
+};
+
+// Derived 为 server 或 client 本身 (poll(*this) 的 handler)，sleep 使用它的 addTimer，waitConnect 要求它是 client
+template <typename Derived>
+class CoroHandler {
+   public:
+    // co_await 得到 n (> 0) 个字节，连接断开时得到空 span
+    template <typename Conn>
+    auto readExact(Conn& conn, uint32_t n) {
+        static_assert(std::is_base_of_v<CoroConnState, Conn>, "Conf::UserData must inherit CoroConnState");
+        struct Awaiter {
+            Conn& conn;
+            uint32_t n;
+
+            bool await_ready() {
+                conn.coro_data = nullptr;
+                return !conn.isConnected();
+            }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                conn.coro_waiter = h;
+                conn.coro_wait = CoroWait::Read;
+                conn.coro_size = n;
+            }
+
+            std::span<const uint8_t> await_resume() {
+                if (!conn.coro_data) return {};
+                return {conn.coro_data, n};
+            }
+        };
+        return Awaiter{conn, n};
+    }
+
+    // co_await 得到是否全部写入 (进入发送队列或已发出)，连接断开时为 false
+    template <typename Conn>
+    auto writeAll(Conn& conn, const void* data, uint32_t size) {
+        static_assert(std::is_base_of_v<CoroConnState, Conn>, "Conf::UserData must inherit CoroConnState");
+        struct Awaiter {
+            Conn& conn;
+            const void* data;
+            uint32_t size;
+
+            bool await_ready() {
+                conn.coro_data = static_cast<const uint8_t*>(data);
+                conn.coro_size = size;
+                return pushWrite(conn, conn);
+            }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                conn.coro_waiter = h;
+                conn.coro_wait = CoroWait::Write;
+            }
+
+            bool await_resume() { return conn.coro_size == 0 && conn.isConnected(); }
+        };
+        return Awaiter{conn, data, size};
+    }
+
+    // co_await 得到 ms 毫秒后是否仍然连接；定时器数量已满时不等待，直接得到 false
+    template <typename Conn>
+    auto sleep(Conn& conn, uint32_t ms) {
+        static_assert(std::is_base_of_v<CoroConnState, Conn>, "Conf::UserData must inherit CoroConnState");
+        struct Awaiter {
+            Derived& owner;
+            Conn& conn;
+            uint32_t ms;
+
+            bool await_ready() {
+                conn.coro_ok = false;
+                return !conn.isConnected();
+            }
+
+            // 回调只捕获一个指针，存放在 std::function 内部，不分配内存
+            bool await_suspend(std::coroutine_handle<> h) {
+                Derived* owner_ptr = &owner;
+                auto on_timer = [owner_ptr](auto& c) {
+                    if (c.coro_wait == CoroWait::Timer) owner_ptr->resumeOutside(c, true);
+                };
+                if (!owner.addTimer(conn, ms, on_timer)) return false;
+                conn.coro_waiter = h;
+                conn.coro_wait = CoroWait::Timer;
+                return true;
+            }
+
+            bool await_resume() { return conn.coro_ok; }
+        };
+        return Awaiter{derived(), conn, ms};
+    }
+
+    // client 的协程中 co_await，得到是否已连接: 已连接时立即返回 true，否则等到下一次连接成功或失败。
+    // 重试间隔由 ConnRetryMs 决定，未配置时连接失败后需要 allowReconnect
+    auto waitConnect() {
+        struct Awaiter {
+            Derived& client;
+
+            bool await_ready() { return client.isConnected(); }
+
+            void await_suspend(std::coroutine_handle<> h) {
+                CoroConnState& st = client;
+                st.coro_waiter = h;
+                st.coro_wait = CoroWait::Connect;
+            }
+
+            bool await_resume() { return client.isConnected(); }
+        };
+        return Awaiter{derived()};
+    }
+
+    template <typename Conn>
+    void onTcpConnected(Conn& conn) {
+        if (conn.coro_wait == CoroWait::Connect) resumeOutside(conn, true);
+        if constexpr (requires { derived().onTcpSession(conn); }) derived().onTcpSession(conn).detach();
+    }
+
+    void onTcpConnectFailed() {
+        if constexpr (std::is_base_of_v<CoroConnState, Derived>) {
+            CoroConnState& st = derived();
+            if (st.coro_wait == CoroWait::Connect) wake(st, false);
+        }
+    }
+
+    // 依次满足等待中的 readExact，协程转而等待其他事件时剩下的数据留在接收缓冲，之后由 redeliver 再交给它
+    template <typename Conn>
+    uint32_t onTcpData(Conn& conn, const uint8_t* data, uint32_t size) {
+        while (conn.coro_wait == CoroWait::Read && conn.coro_size <= size) {
+            uint32_t n = conn.coro_size;
+            conn.coro_data = data;
+            data += n;
+            size -= n;
+            wake(conn, true);
+            if (!conn.isConnected()) return 0;
+        }
+        return size;
+    }
+
+    // 所有等待都以失败结束
+    template <typename Conn>
+    void onTcpDisconnect(Conn& conn) {
+        if (conn.coro_wait != CoroWait::None) wake(conn, false);
+    }
+
+    template <typename Conn>
+    void onSendDrained(Conn& conn) {
+        if (conn.coro_wait == CoroWait::Write && pushWrite(conn, conn)) resumeOutside(conn, true);
+    }
+
+    // 超过 RecvTimeout 没有收到数据时关闭连接，等待中的协程在 onTcpDisconnect 中得到失败
+    template <typename Conn>
+    void onRecvTimeout(Conn& conn) {
+        conn.close("timeout");
+    }
+
+    // SendTimeout 是空闲一段时间没有发送的心跳时机，默认不做事，需要心跳的派生类自己定义
+    template <typename Conn>
+    void onSendTimeout(Conn&) {}
+
+    // 在数据回调之外恢复协程 (定时器、发送队列发完、连接建立)，协程随后开始等待数据时把接收缓冲中已有的数据交给它
+    template <typename Conn>
+    void resumeOutside(Conn& conn, bool ok) {
+        wake(conn, ok);
+        if (conn.coro_wait == CoroWait::Read) conn.redeliver(derived());
+    }
+
+   private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+
+    static void wake(CoroConnState& st, bool ok) {
+        std::coroutine_handle<> h = std::exchange(st.coro_waiter, {});
+        if (!ok && st.coro_wait == CoroWait::Read) st.coro_data = nullptr;
+        st.coro_wait = CoroWait::None;
+        st.coro_ok = ok;
+        h.resume();
+    }
+
+    // 把 coro_data 中剩余的数据写入发送队列，最多写到队列满；返回是否结束 (全部写入或连接已断开)
+    template <typename Conf>
+    static bool pushWrite(SocketTcpConnection<Conf>& conn, CoroConnState& st) {
+        constexpr uint32_t SendBufSize = conf_send_buf_size<Conf>();
+        while (st.coro_size && conn.isConnected()) {
+            uint32_t n = st.coro_size;
+            if constexpr (SendBufSize > 0) n = std::min(n, SendBufSize - conn.getSendQueued());
+            if (n == 0) return false;
+            if (!conn.write(st.coro_data, n)) break;
+            st.coro_data += n;
+            st.coro_size -= n;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+// ==========================================
+// 编译期分帧与按消息类型分发 (Framing)
+// ==========================================
+// 用法: 在 onTcpData 中 return FrameDispatcher<Framing, MaxFrameSize, Msgs...>::dispatch(*this, conn, data, size);
+// 直接在 read 缓冲上原地分帧，不拷贝；帧头一到就检查长度，超过 MaxFrameSize (通常为 RecvBufSize) 的帧立即断开连接，
+// 不会等到接收缓冲写满。分帧方式由 Framing 决定:
+//   LengthPrefixedFraming<Header, &Header::body_len[, &Header::msg_type]>  帧头 + body_len 字节的 body
+//   FixedSizeFraming<Size[, TypeT, TypeOffset]>                            固定长度的帧
+//   DelimiterFraming<'\n'>                                                 以分隔符结尾的帧 (含分隔符)
+// Msgs 为空时每帧回调 handler.onFrame(conn, frame, size)；
+// 否则按帧中的消息类型查编译期生成的跳转表，回调 handler.onMsg(conn, const T&) 或 onMsg(conn, const T&, size)，
+// T 为 Msgs 中 T::MsgType 等于该类型的结构体 (包含帧头，原地 reinterpret，协议结构体通常 #pragma pack(1))。
+// 没有对应 T 的类型回调可选的 handler.onUnknownMsg(conn, frame, size)，未定义时断开连接。
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// frameSize 的返回值: 帧非法 (长度超过上限等)，调用方应断开连接
+inline constexpr uint32_t FrameError = UINT32_MAX;
+
+// 帧头在帧的开头，body_len 不含帧头；BodyLen/MsgTypeField 为 Header 的成员指针，按主机字节序读取
+template <typename Header, auto BodyLen, auto MsgTypeField = nullptr>
+struct LengthPrefixedFraming {
+    static_assert(std::is_trivially_copyable_v<Header>, "Header must be trivially copyable");
+
+    // 返回完整帧的长度，数据不足一帧时返回 0
+    static uint32_t frameSize(const uint8_t* data, uint32_t size, uint32_t max_size) {
+        if (size < sizeof(Header)) return 0;
+        // 帧头可能不对齐，memcpy 会被编译成普通的 load
+        Header hdr;
+        memcpy(&hdr, data, sizeof(hdr));
+        uint64_t total = sizeof(Header) + static_cast<uint64_t>(hdr.*BodyLen);
+        if (total > max_size) return FrameError;
+        return total <= size ? static_cast<uint32_t>(total) : 0;
+    }
+
+    static uint32_t msgType(const uint8_t* frame)
+        requires(!std::is_same_v<decltype(MsgTypeField), std::nullptr_t>)
+    {
+        Header hdr;
+        memcpy(&hdr, frame, sizeof(hdr));
+        return static_cast<uint32_t>(hdr.*MsgTypeField);
+    }
+};
+
+// 每帧 Size 字节，消息类型为 TypeOffset 处的 TypeT (TypeT 为 void 时不按类型分发)
+template <uint32_t Size, typename TypeT = void, uint32_t TypeOffset = 0>
+struct FixedSizeFraming {
+    static_assert(Size > 0, "Size must be positive");
+
+    static uint32_t frameSize(const uint8_t*, uint32_t size, uint32_t max_size) {
+        if (Size > max_size) return FrameError;
+        return size >= Size ? Size : 0;
+    }
+
+    static uint32_t msgType(const uint8_t* frame)
+        requires(!std::is_void_v<TypeT>)
+    {
+        static_assert(TypeOffset + sizeof(TypeT) <= Size, "msg type field out of frame");
+        TypeT type;
+        memcpy(&type, frame + TypeOffset, sizeof(type));
+        return static_cast<uint32_t>(type);
+    }
+};
+
+// 帧以 Delim 结尾 (回调的帧包含 Delim)，max_size 字节内找不到 Delim 时为非法帧；不按类型分发
+template <char Delim>
+struct DelimiterFraming {
+    static uint32_t frameSize(const uint8_t* data, uint32_t size, uint32_t max_size) {
+        const void* end = memchr(data, Delim, std::min(size, max_size));
+        if (end) return static_cast<uint32_t>(static_cast<const uint8_t*>(end) - data) + 1;
+        return size >= max_size ? FrameError : 0;
+    }
+};
+
+template <typename Framing, uint32_t MaxFrameSize, typename... Msgs>
+class FrameDispatcher {
+    static constexpr uint32_t typeCnt() {
+        uint32_t cnt = 0;
+        ((cnt = std::max<uint32_t>(cnt, Msgs::MsgType + 1)), ...);
+        return cnt;
+    }
+
+    static constexpr bool distinctTypes() {
+        constexpr uint32_t types[] = {Msgs::MsgType..., 0};
+        for (uint32_t i = 0; i < sizeof...(Msgs); i++)
+            for (uint32_t j = i + 1; j < sizeof...(Msgs); j++)
+                if (types[i] == types[j]) return false;
+        return true;
+    }
+
+    static constexpr uint32_t TypeCnt = typeCnt();
+    static_assert(MaxFrameSize > 0, "MaxFrameSize must be positive");
+    static_assert((std::is_trivially_copyable_v<Msgs> && ...), "messages must be trivially copyable");
+    static_assert(((sizeof(Msgs) <= MaxFrameSize) && ...), "message larger than MaxFrameSize");
+    static_assert(distinctTypes(), "duplicate MsgType");
+    // 跳转表按最大的类型值分配，类型值应当紧凑
+    static_assert(TypeCnt <= 65536, "MsgType too large for a jump table");
+
+    template <typename Handler, typename Conn>
+    using MsgFn = void (*)(Handler&, Conn&, const uint8_t*, uint32_t);
+
+    template <typename Handler, typename Conn, typename T>
+    static void onMsg(Handler& handler, Conn& conn, const uint8_t* frame, uint32_t size) {
+        if (size < sizeof(T)) {
+            conn.close("frame shorter than msg");
+            return;
+        }
+        const T& msg = *reinterpret_cast<const T*>(frame);
+        if constexpr (requires { handler.onMsg(conn, msg, size); })
+            handler.onMsg(conn, msg, size);
+        else
+            handler.onMsg(conn, msg);
+    }
+
+    template <typename Handler, typename Conn>
+    static void onUnknown(Handler& handler, Conn& conn, const uint8_t* frame, uint32_t size) {
+        if constexpr (requires { handler.onUnknownMsg(conn, frame, size); })
+            handler.onUnknownMsg(conn, frame, size);
+        else
+            conn.close("unknown msg type");
+    }
+
+    template <typename Handler, typename Conn>
+    static constexpr std::array<MsgFn<Handler, Conn>, TypeCnt> makeTable() {
+        std::array<MsgFn<Handler, Conn>, TypeCnt> table{};
+        table.fill(&onUnknown<Handler, Conn>);
+        ((table[Msgs::MsgType] = &onMsg<Handler, Conn, Msgs>), ...);
+        return table;
+    }
+
+    template <typename Handler, typename Conn>
+    static constexpr std::array<MsgFn<Handler, Conn>, TypeCnt> table_ = makeTable<Handler, Conn>();
+
+   public:
+    // 逐帧回调 handler，返回剩余的半包字节数 (onTcpData 的返回值)；非法帧断开连接，回调中断开连接时停止分发并返回 0
+    template <typename Handler, typename Conn>
+    static uint32_t dispatch(Handler& handler, Conn& conn, const uint8_t* data, uint32_t size) {
+        while (conn.isConnected()) {
+            uint32_t n = Framing::frameSize(data, size, MaxFrameSize);
+            if (n == 0) break;
+            if (n == FrameError) {
+                conn.close("frame too large");
+                return 0;
+            }
+            if constexpr (sizeof...(Msgs) == 0) {
+                handler.onFrame(conn, data, n);
+            } else {
+                uint32_t type = Framing::msgType(data);
+                if (type < TypeCnt)
+                    table_<Handler, Conn>[type](handler, conn, data, n);
+                else
+                    onUnknown(handler, conn, data, n);
+            }
+            data += n;
+            size -= n;
+        }
+        // 连接已在回调中关闭时剩余的数据没有意义，返回 0 以免 pollnet 按关闭前的缓冲位置保留半包
+        return conn.isConnected() ? size : 0;
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+// ==========================================
+// 轮询线程的空闲策略 (Idle Strategy)
+// ==========================================
+// 用法: while (running) idle.idle(server.poll(server), server);
+// poll 返回本次是否做了事 (新连接、收到数据、断开、定时器到期)，做了事时重置空闲计数，
+// 连续空闲 spins 次之后按策略降低 CPU 占用，延迟依次升高:
+//   SpinIdle      一直空转，延迟最低，独占一个核
+//   SpinPauseIdle 之后每次插入 pause 指令，降低功耗并把流水线让给同核的超线程
+//   SpinYieldIdle 之后每次 sched_yield，有其他线程时让出 CPU
+//   SpinBlockIdle 之后调用 source.wait(timeout_ms)，阻塞在 epoll/poll 上直到有事件或超时；
+//                 阻塞期间不推进时间轮，定时器最多推迟 timeout_ms
+
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+inline void cpu_pause() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+class SpinIdle {
+   public:
+    template <typename Source>
+    void idle(bool, Source&) {}
+};
+
+class SpinPauseIdle {
+   public:
+    explicit SpinPauseIdle(uint32_t spins = 1000) : spins_(spins) {}
+
+    template <typename Source>
+    void idle(bool did_work, Source&) {
+        if (did_work)
+            idle_cnt_ = 0;
+        else if (idle_cnt_ < spins_)
+            idle_cnt_++;
+        else
+            cpu_pause();
+    }
+
+   private:
+    uint32_t spins_;
+    uint32_t idle_cnt_ = 0;
+};
+
+class SpinYieldIdle {
+   public:
+    explicit SpinYieldIdle(uint32_t spins = 1000) : spins_(spins) {}
+
+    template <typename Source>
+    void idle(bool did_work, Source&) {
+        if (did_work)
+            idle_cnt_ = 0;
+        else if (idle_cnt_ < spins_)
+            idle_cnt_++;
+        else
+            std::this_thread::yield();
+    }
+
+   private:
+    uint32_t spins_;
+    uint32_t idle_cnt_ = 0;
+};
+
+// source 需要提供 bool wait(int timeout_ms)
+class SpinBlockIdle {
+   public:
+    explicit SpinBlockIdle(uint32_t spins = 1000, int timeout_ms = 1) : spins_(spins), timeout_ms_(timeout_ms) {}
+
+    template <typename Source>
+    void idle(bool did_work, Source& source) {
+        if (did_work)
+            idle_cnt_ = 0;
+        else if (idle_cnt_ < spins_)
+            idle_cnt_++;
+        else
+            source.wait(timeout_ms_);
+    }
+
+   private:
+    uint32_t spins_;
+    int timeout_ms_;
+    uint32_t idle_cnt_ = 0;
+};
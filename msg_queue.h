@@ -0,0 +1,122 @@
+#pragma once
+
+// ==========================================
+// I/O 线程与工作线程之间的无锁消息队列
+// ==========================================
+// 把耗时的处理移出 poll 线程: I/O 线程在 onTcpData 中把完整的消息连同 ConnHandle 推入 SpscMsgQueue，
+// 工作线程取出处理，结果通过 server.reply(handle, data, size) 推入 server 持有的 MpscMsgQueue，
+// 由 server 的 poll 取出并写到对应连接上。连接在此期间断开或槽位被新连接复用时，回复被丢弃。
+//
+// 有界环形队列，每个槽位固定 MaxMsgSize 字节 (加上头部按 cache line 对齐)，槽位上的序号表示它当前属于生产者还是消费者
+// (Vyukov 的有界队列)，生产者和消费者的位置各占一个 cache line。SPSC 生产者不需要 CAS，MPSC 生产者用一次 CAS 抢位置。
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// 跨线程引用一个连接: 槽位下标 + 打开次数，连接重新打开后旧的 handle 失效
+struct ConnHandle {
+    uint32_t idx = UINT32_MAX;
+    uint32_t session = 0;
+};
+
+template <uint32_t MaxMsgSize, uint32_t Len, bool MultiProducer>
+class MsgQueue {
+    static_assert(Len >= 2 && (Len & (Len - 1)) == 0, "Len must be a power of 2");
+    static constexpr uint32_t HeaderSize = sizeof(std::atomic<uint64_t>) + sizeof(ConnHandle) + sizeof(uint32_t);
+    static constexpr uint32_t SlotSize = (HeaderSize + MaxMsgSize + 63) / 64 * 64;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq;
+        ConnHandle conn;
+        uint32_t size;
+        uint8_t data[SlotSize - HeaderSize];
+    };
+    static_assert(sizeof(Slot) == SlotSize);
+
+   public:
+    MsgQueue() : slots_(std::make_unique<Slot[]>(Len)) {
+        for (uint32_t i = 0; i < Len; i++) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MsgQueue(const MsgQueue&) = delete;
+    MsgQueue& operator=(const MsgQueue&) = delete;
+
+    // 生产者调用，队列满或 size 超过 MaxMsgSize 时返回 false
+    bool push(ConnHandle conn, const void* data, uint32_t size) {
+        if (size > MaxMsgSize) return false;
+        uint64_t pos;
+        Slot* slot = claim(pos);
+        if (!slot) return false;
+        slot->conn = conn;
+        slot->size = size;
+        memcpy(slot->data, data, size);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用，依次回调 handler(ConnHandle, const uint8_t* data, uint32_t size)，最多 max_cnt 条，返回取出的条数；
+    // 回调返回后槽位即归还给生产者，data 不能在回调之外保留
+    template <typename Handler>
+    uint32_t poll(Handler handler, uint32_t max_cnt = Len) {
+        uint32_t cnt = 0;
+        for (; cnt < max_cnt; cnt++) {
+            Slot& slot = slots_[consumer_.pos & (Len - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != consumer_.pos + 1) break;
+            handler(slot.conn, slot.data, slot.size);
+            slot.seq.store(consumer_.pos + Len, std::memory_order_release);
+            consumer_.pos++;
+        }
+        return cnt;
+    }
+
+    // 消费者调用
+    bool empty() {
+        const Slot& slot = slots_[consumer_.pos & (Len - 1)];
+        return slot.seq.load(std::memory_order_acquire) != consumer_.pos + 1;
+    }
+
+   private:
+    // 成功时返回槽位，pos 为它的位置
+    Slot* claim(uint64_t& pos) {
+        pos = producer_.pos.load(std::memory_order_relaxed);
+        if constexpr (!MultiProducer) {
+            Slot& slot = slots_[pos & (Len - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != pos) return nullptr;
+            producer_.pos.store(pos + 1, std::memory_order_relaxed);
+            return &slot;
+        } else {
+            while (true) {
+                Slot& slot = slots_[pos & (Len - 1)];
+                int64_t diff = static_cast<int64_t>(slot.seq.load(std::memory_order_acquire) - pos);
+                if (diff == 0) {
+                    if (producer_.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &slot;
+                } else if (diff < 0) {
+                    return nullptr;  // 消费者还没取走上一圈的消息
+                } else {
+                    pos = producer_.pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    struct alignas(64) ProducerPos {
+        std::atomic<uint64_t> pos{0};
+    };
+    struct alignas(64) ConsumerPos {
+        uint64_t pos = 0;
+    };
+
+    ProducerPos producer_;
+    ConsumerPos consumer_;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+// 一个生产者、一个消费者，例如 I/O 线程 -> 某个工作线程
+template <uint32_t MaxMsgSize, uint32_t Len>
+using SpscMsgQueue = MsgQueue<MaxMsgSize, Len, false>;
+
+// 多个生产者、一个消费者，例如所有工作线程 -> I/O 线程
+template <uint32_t MaxMsgSize, uint32_t Len>
+using MpscMsgQueue = MsgQueue<MaxMsgSize, Len, true>;
@@ -0,0 +1,139 @@
+#pragma once
+
+// ==========================================
+// SO_REUSEPORT 多线程 TCP server (仅 Linux)
+// ==========================================
+// N 个 SocketTcpServer 绑定同一端口，各自一个线程 (可绑核) 和独立的连接表，
+// 内核按四元组哈希 (或 steerByCpu 的 CBPF 程序) 把新连接分给其中一个，连接之后只在该线程内处理。
+// Handler 接口与 SocketTcpServer 相同，回调发生在各 shard 线程中。
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "socket.h"
+
+template <typename Conf>
+class SocketTcpShardedServer {
+   public:
+    using Server = SocketTcpServer<Conf>;
+    using Conn = typename Server::Conn;
+
+    ~SocketTcpShardedServer() { stop(); }
+
+    // cpus: 长度为 shard_cnt，shard i 的线程绑定到 cpus[i]，为空时不绑核；
+    // steer_by_cpu: 新连接交给与收包 CPU 相同的 shard (需要网卡队列中断亲和性与 cpus 对应)
+    bool init(const char* interface_ip, const char* server_ip, uint16_t server_port, uint32_t shard_cnt,
+              const int* cpus = nullptr, bool steer_by_cpu = false) {
+        shard_cnt_ = shard_cnt;
+        shards_ = std::make_unique<Shard[]>(shard_cnt);
+        for (uint32_t i = 0; i < shard_cnt; i++) {
+            shards_[i].cpu = cpus ? cpus[i] : -1;
+            if (!shards_[i].server.init(interface_ip, server_ip, server_port, true)) {
+                saveError(shards_[i].server.getLastError());
+                return false;
+            }
+        }
+        if (steer_by_cpu && !shards_[0].server.steerByCpu(cpus, shard_cnt)) {
+            saveError(shards_[0].server.getLastError());
+            return false;
+        }
+        return true;
+    }
+
+    // get_handler(shard) 返回该 shard 使用的 Handler&；多个 shard 返回同一个 handler 时，handler 需自行保证线程安全。
+    // idle 为空闲策略 (见 idle_strategy.h)，每个 shard 线程复制一份；默认一直空转
+    template <typename GetHandler, typename Idle = SpinIdle>
+    void start(GetHandler get_handler, Idle idle = Idle()) {
+        running_.store(true, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < shard_cnt_; i++) {
+            Shard& shard = shards_[i];
+            shard.thread = std::thread([this, &shard, &handler = get_handler(i), idle] { run(shard, handler, idle); });
+        }
+    }
+
+    void stop() {
+        running_.store(false, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < shard_cnt_; i++) {
+            if (shards_[i].thread.joinable()) shards_[i].thread.join();
+        }
+    }
+
+    const char* getLastError() { return last_error_; }
+
+    uint32_t getShardCnt() { return shard_cnt_; }
+
+    // 各 shard 在每次 poll 之后发布自己的连接数，这里的合计是近似值
+    uint32_t getConnCnt() {
+        uint32_t cnt = 0;
+        for (uint32_t i = 0; i < shard_cnt_; i++) cnt += shards_[i].conn_cnt.load(std::memory_order_relaxed);
+        return cnt;
+    }
+
+    // 各 shard 计数之和 (Conf::Stats 为 true 时有效)，计数本身无锁，可以在任意线程调用
+    SocketStats getStats() {
+        SocketStats stats;
+        for (uint32_t i = 0; i < shard_cnt_; i++) stats += shards_[i].server.getStats();
+        return stats;
+    }
+
+    // 运行中依次请求每个 shard 在自己的线程里遍历连接并等待完成；不能在 shard 线程的回调中调用，也不能多线程同时调用
+    template <typename Handler>
+    void foreachConn(Handler handler) {
+        for (uint32_t i = 0; i < shard_cnt_; i++) {
+            Shard& shard = shards_[i];
+            if (!shard.thread.joinable()) {
+                shard.server.foreachConn(handler);
+                continue;
+            }
+            visit_ctx_ = &handler;
+            visit_fn_ = [](void* ctx, Conn& conn) { (*static_cast<Handler*>(ctx))(conn); };
+            shard.visit.store(true, std::memory_order_release);
+            while (shard.visit.load(std::memory_order_acquire)) std::this_thread::yield();
+        }
+    }
+
+    // 直接访问某个 shard，只能在该 shard 线程内或未运行时使用
+    Server& getShard(uint32_t i) { return shards_[i].server; }
+
+   private:
+    struct Shard {
+        Server server;
+        std::thread thread;
+        int cpu = -1;
+        std::atomic<uint32_t> conn_cnt{0};
+        std::atomic<bool> visit{false};
+    };
+
+    template <typename Handler, typename Idle>
+    void run(Shard& shard, Handler& handler, Idle idle) {
+        if (shard.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(shard.cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+        while (running_.load(std::memory_order_relaxed)) {
+            bool did_work = shard.server.poll(handler);
+            shard.conn_cnt.store(shard.server.getConnCnt(), std::memory_order_relaxed);
+            if (shard.visit.load(std::memory_order_acquire)) {
+                shard.server.foreachConn([this](Conn& conn) { visit_fn_(visit_ctx_, conn); });
+                shard.visit.store(false, std::memory_order_release);
+                did_work = true;
+            }
+            idle.idle(did_work, shard.server);
+        }
+    }
+
+    void saveError(const char* msg) { snprintf(last_error_, sizeof(last_error_), "%s", msg); }
+
+    uint32_t shard_cnt_ = 0;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<bool> running_{false};
+    void* visit_ctx_ = nullptr;
+    void (*visit_fn_)(void* ctx, Conn& conn) = nullptr;
+    char last_error_[64] = "";
+};
@@ -0,0 +1,68 @@
+#include <print>
+#include <string>
+
+#include "framing.h"
+#include "shm_transport.h"
+
+struct ClientConf {
+    static const uint32_t ShmRingSize = 1 << 16;
+    static const uint32_t ConnRetrySec = 3;
+    struct UserData {};
+};
+
+using ShmClient = SocketShmClient<ClientConf>;
+
+struct MsgHeader {
+    uint32_t body_len;
+};
+
+using Dispatcher = FrameDispatcher<LengthPrefixedFraming<MsgHeader, &MsgHeader::body_len>, 4096>;
+
+// 每收到一条回显发送下一条，共 Count 条
+class MyClient : public ShmClient {
+    static constexpr uint32_t Count = 5;
+    uint32_t sent_ = 0;
+
+    void send() {
+        std::string body = "hello " + std::to_string(sent_++);
+        MsgHeader header{static_cast<uint32_t>(body.size())};
+        // 共享内存连接没有 writev，拼成一帧写入环形缓冲
+        std::string req(reinterpret_cast<const char*>(&header), sizeof(header));
+        req += body;
+        this->write(req.data(), req.size());
+    }
+
+   public:
+    bool done = false;
+
+    void onTcpConnectFailed() { std::println("connect error:{}", this->getLastError()); }
+    void onTcpConnected(ShmClient::Conn&) {
+        std::println("connected!");
+        sent_ = 0;
+        send();
+    }
+    void onTcpDisconnect(ShmClient::Conn&) { std::println("disconnected: {}", this->getLastError()); }
+    uint32_t onTcpData(ShmClient::Conn& conn, const uint8_t* data, uint32_t size) {
+        return Dispatcher::dispatch(*this, conn, data, size);
+    }
+    void onFrame(ShmClient::Conn& conn, const uint8_t* frame, uint32_t size) {
+        std::string_view body{reinterpret_cast<const char*>(frame) + sizeof(MsgHeader), size - sizeof(MsgHeader)};
+        std::println("Recv Body [len: {}]: {}", body.size(), body);
+        if (sent_ < Count)
+            send();
+        else {
+            conn.close("done");
+            done = true;
+        }
+    }
+};
+
+int main(int argc, char const* argv[]) {
+    MyClient client;
+    client.init("@pollnet_shm_example");
+    SpinBlockIdle idle;
+    while (!client.done) {
+        idle.idle(client.poll(client), client);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include <cstdint>
+#include <print>
+#include <string_view>
+
+#include "framing.h"
+#include "shm_transport.h"
+
+struct ServerConf {
+    static const uint32_t ShmRingSize = 1 << 16;
+    static const uint32_t MaxConns = 10;
+    struct UserData {};
+};
+
+using ShmServer = SocketShmServer<ServerConf>;
+
+struct MsgHeader {
+    uint32_t body_len;
+};
+
+// 与 tcp_server 相同的协议，body_len 超过 4KB 的帧直接断开连接
+using Dispatcher = FrameDispatcher<LengthPrefixedFraming<MsgHeader, &MsgHeader::body_len>, 4096>;
+
+class MyServer : public ShmServer {
+   public:
+    void onTcpConnected(ShmServer::Conn&) { std::println("new connection, total={}", getConnCnt()); }
+    // data 直接指向共享内存中的环形缓冲
+    uint32_t onTcpData(ShmServer::Conn& conn, const uint8_t* data, uint32_t size) {
+        return Dispatcher::dispatch(*this, conn, data, size);
+    }
+    // 原样回显
+    void onFrame(ShmServer::Conn& conn, const uint8_t* frame, uint32_t size) {
+        std::string_view body{reinterpret_cast<const char*>(frame) + sizeof(MsgHeader), size - sizeof(MsgHeader)};
+        std::println("Recv Body [len: {}]: {}", body.size(), body);
+        conn.write(frame, size);
+    }
+    void onTcpDisconnect(ShmServer::Conn& conn) {
+        std::println("client disconnected, reason={}, total={}", conn.getLastError(), getConnCnt());
+    }
+};
+
+int main(int argc, char const* argv[]) {
+    MyServer server;
+    // 以 @ 开头为 abstract unix socket，不在文件系统中留下文件
+    if (!server.init("@pollnet_shm_example")) {
+        std::println("init failed: {}", server.getLastError());
+        return 1;
+    }
+    // 空闲超过 1000 次 poll 后阻塞在 unix socket 上，客户端写入时会唤醒
+    SpinBlockIdle idle;
+    while (true) {
+        idle.idle(server.poll(server), server);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,589 @@
+#pragma once
+
+// ==========================================
+// 同机共享内存传输 (仅 Linux)
+// ==========================================
+// 每个连接两个方向各一块 memfd，内含一个 SPSC 字节环形缓冲，收发都只是内存读写，不经过内核协议栈。
+// 建连走 AF_UNIX SOCK_SEQPACKET: 客户端连上 server 的 unix socket，server 创建两块 memfd 用 SCM_RIGHTS 发给客户端；
+// 之后 unix socket 只用来检测对端进程退出 (每秒检查一次 EOF) 和唤醒阻塞在 wait 中的对端，正常 close 通过环形缓冲头部的标志立即通知对端。
+// Handler 接口与 SocketTcpServer/SocketTcpClient 相同 (onTcpConnected/onTcpData/onTcpDisconnect/onTcpConnectFailed)，
+// onTcpData(conn, data, size) 同样返回未处理的字节数，data 直接指向共享内存，不做拷贝。
+// poll/wait/write 等调用也与 TCP 相同，可以配合空闲策略使用；只有 init 不同，参数是 unix socket 路径而不是 IP 和端口。
+// 不支持收发超时、addTimer 和发送队列，write 在对端来不及读时自旋等待，对端进程退出时返回 false。
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "socket.h"
+
+// 每个方向的环形缓冲大小，必须是 2 的幂且不小于页大小；一条消息不能超过该大小
+template <typename Conf>
+constexpr uint32_t conf_shm_ring_size() {
+    if constexpr (requires { Conf::ShmRingSize; })
+        return Conf::ShmRingSize;
+    else
+        return 1 << 20;
+}
+
+// memfd 的第一页为头部，写端和读端的位置各占一个 cache line；位置单调递增，取模得到偏移。
+// reader_closed/reader_waiting 单独占一个 cache line，写端每次写入都检查它们，不能和频繁更新的 read_pos 放在一起
+struct ShmRingHeader {
+    alignas(64) uint64_t write_pos;
+    uint32_t writer_closed;
+    alignas(64) uint64_t read_pos;
+    alignas(64) uint32_t reader_closed;
+    uint32_t reader_waiting;  // 读端阻塞在 wait 中，写端写入后需要通过 unix socket 唤醒
+};
+
+// 数据区与 MirrorBuffer 一样连续映射两次，读写总是连续的
+class ShmRing {
+   public:
+    static constexpr uint32_t HeaderSize = 4096;
+
+    ShmRing() = default;
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+    ~ShmRing() { unmap(); }
+
+    // 创建一块新的 memfd (内容全为 0)，失败返回 -1
+    static int create(uint32_t size) {
+        int fd = memfd_create("pollnet_shm", MFD_CLOEXEC);
+        if (fd < 0) return -1;
+        if (ftruncate(fd, HeaderSize + static_cast<off_t>(size)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool map(int fd, uint32_t size) {
+        size_t total = HeaderSize + 2 * static_cast<size_t>(size);
+        void* p = mmap(nullptr, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return false;
+        uint8_t* base = static_cast<uint8_t*>(p);
+        if (mmap(base, HeaderSize + size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED | MAP_POPULATE, fd, 0) ==
+                MAP_FAILED ||
+            mmap(base + HeaderSize + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, HeaderSize) ==
+                MAP_FAILED) {
+            munmap(base, total);
+            return false;
+        }
+        base_ = base;
+        size_ = size;
+        return true;
+    }
+
+    void unmap() {
+        if (base_) munmap(base_, HeaderSize + 2 * static_cast<size_t>(size_));
+        base_ = nullptr;
+    }
+
+    ShmRingHeader& header() { return *reinterpret_cast<ShmRingHeader*>(base_); }
+    uint8_t* data() { return base_ + HeaderSize; }
+
+   private:
+    uint8_t* base_ = nullptr;
+    uint32_t size_ = 0;
+};
+
+// 建连时 server 发给客户端的消息，附带 [c2s, s2c] 两个 memfd
+struct ShmHello {
+    static constexpr uint32_t Magic = 0x706e7368;  // "pnsh"
+    uint32_t magic;
+    uint32_t ring_size;
+};
+
+template <typename Conf>
+class SocketShmServer;
+
+template <typename Conf>
+class SocketShmConnection : public Conf::UserData {
+   protected:
+    static constexpr uint32_t RingSize = conf_shm_ring_size<Conf>();
+    static_assert((RingSize & (RingSize - 1)) == 0 && RingSize >= ShmRing::HeaderSize,
+                  "ShmRingSize must be a power of 2 and at least one page");
+
+   public:
+    ~SocketShmConnection() { close("destruct"); }
+
+    const char* getLastError() { return last_error_; }
+
+    bool isConnected() { return ctl_fd_ >= 0; }
+
+    // 对端通过环形缓冲头部的关闭标志立即得知
+    void close(const char* reason, bool check_errno = false) {
+        if (ctl_fd_ < 0) return;
+        saveError(reason, check_errno);
+        std::atomic_ref<uint32_t>(tx_.header().writer_closed).store(1, std::memory_order_release);
+        std::atomic_ref<uint32_t>(rx_.header().reader_closed).store(1, std::memory_order_release);
+        tx_.unmap();
+        rx_.unmap();
+        ::close(ctl_fd_);
+        ctl_fd_ = -1;
+    }
+
+    // 返回写入的字节数，空间不足时只写一部分，对端已关闭时关闭连接并返回 -1
+    int writeSome(const void* data, uint32_t size, bool more = false) {
+        if (!isConnected()) return -1;
+        ShmRingHeader& h = tx_.header();
+        // 与 TCP 一样，对端关闭后的写入立即失败；reader_closed 只在关闭时写一次，读它不会引起 cache line 争用
+        if (std::atomic_ref<uint32_t>(h.reader_closed).load(std::memory_order_acquire)) {
+            close("remote close");
+            return -1;
+        }
+        uint32_t space = RingSize - static_cast<uint32_t>(tx_write_ - tx_read_);
+        if (space < size) {
+            tx_read_ = std::atomic_ref<uint64_t>(h.read_pos).load(std::memory_order_acquire);
+            space = RingSize - static_cast<uint32_t>(tx_write_ - tx_read_);
+        }
+        uint32_t n = std::min(size, space);
+        memcpy(tx_.data() + (tx_write_ & (RingSize - 1)), data, n);
+        tx_write_ += n;
+        std::atomic_ref<uint64_t>(h.write_pos).store(tx_write_, std::memory_order_release);
+        // 与 beginWait 成对的 seq_cst 栅栏: 读端要么看到新的 write_pos，要么这里看到 reader_waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (std::atomic_ref<uint32_t>(h.reader_waiting).load(std::memory_order_relaxed)) wakePeer(h);
+        return n;
+    }
+
+    // 与 TCP 的 write 相同，对端读得慢时自旋直到全部写入；对端进程崩溃时不会设置 reader_closed，
+    // 自旋中每 PeerCheckSpins 次检查一次 unix socket 的 EOF，发现后关闭连接并返回 false
+    bool write(const void* data_, uint32_t size, bool more = false) {
+        const uint8_t* data = static_cast<const uint8_t*>(data_);
+        for (uint32_t spins = 1;; spins++) {
+            int sent = writeSome(data, size, more);
+            if (sent < 0) return false;
+            data += sent;
+            size -= sent;
+            if (size == 0) return true;
+            if (spins % PeerCheckSpins == 0) checkPeer();
+            cpu_pause();
+        }
+    }
+
+    // 空间不足以一次写完时关闭连接
+    bool writeNonblock(const void* data, uint32_t size, bool more = false) {
+        if (static_cast<uint32_t>(writeSome(data, size, more)) != size) {
+            close("send buf full");
+            return false;
+        }
+        return true;
+    }
+
+   protected:
+    template <typename Conf_>
+    friend class SocketShmServer;
+
+    static constexpr uint32_t PeerCheckSpins = 4096;
+
+    // 接管 unix socket (失败时关闭) 并映射两个方向的 memfd，memfd 由调用者关闭
+    bool open(int ctl_fd, int tx_fd, int rx_fd) {
+        if (!tx_.map(tx_fd, RingSize) || !rx_.map(rx_fd, RingSize)) {
+            saveError("mmap shm ring error", true);
+            tx_.unmap();
+            ::close(ctl_fd);
+            return false;
+        }
+        ctl_fd_ = ctl_fd;
+        tx_write_ = std::atomic_ref<uint64_t>(tx_.header().write_pos).load(std::memory_order_relaxed);
+        tx_read_ = std::atomic_ref<uint64_t>(tx_.header().read_pos).load(std::memory_order_relaxed);
+        rx_read_ = rx_seen_ = std::atomic_ref<uint64_t>(rx_.header().read_pos).load(std::memory_order_relaxed);
+        return true;
+    }
+
+    // 有新数据时以 [read_pos, write_pos) 回调 handler，返回是否收到数据或断开
+    template <typename Handler>
+    bool pollConn(Handler& handler) {
+        ShmRingHeader& h = rx_.header();
+        // 先读关闭标志再读 write_pos，写端在关闭前写入的数据一定能看到
+        bool closed = std::atomic_ref<uint32_t>(h.writer_closed).load(std::memory_order_acquire);
+        uint64_t w = std::atomic_ref<uint64_t>(h.write_pos).load(std::memory_order_acquire);
+        if (w == rx_seen_) {
+            if (closed) close("remote close");
+            return closed;
+        }
+        rx_seen_ = w;
+        uint32_t size = w - rx_read_;
+        uint32_t remaining = handler.onTcpData(*this, rx_.data() + (rx_read_ & (RingSize - 1)), size);
+        if (!isConnected()) return true;
+        if (remaining >= RingSize) {
+            close("recv buf full");
+            return true;
+        }
+        rx_read_ += size - remaining;
+        std::atomic_ref<uint64_t>(h.read_pos).store(rx_read_, std::memory_order_release);
+        return true;
+    }
+
+    // 读掉对端的唤醒字节；对端进程退出时 unix socket 读到 EOF
+    void checkPeer() {
+        char buf[64];
+        while (true) {
+            ssize_t n = ::recv(ctl_fd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n > 0) continue;
+            if (n == 0)
+                close("remote close");
+            else if (!is_would_block(errno))
+                close("unix socket error", true);
+            return;
+        }
+    }
+
+    // 设置 reader_waiting 后返回是否已有未交给 handler 的数据或关闭标志，为 false 时可以阻塞在 ctl_fd_ 上等待唤醒
+    bool beginWait() {
+        ShmRingHeader& h = rx_.header();
+        std::atomic_ref<uint32_t>(h.reader_waiting).store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return std::atomic_ref<uint32_t>(h.writer_closed).load(std::memory_order_acquire) ||
+               std::atomic_ref<uint64_t>(h.write_pos).load(std::memory_order_acquire) != rx_seen_;
+    }
+
+    void endWait() { std::atomic_ref<uint32_t>(rx_.header().reader_waiting).store(0, std::memory_order_relaxed); }
+
+    // 只有第一个看到 reader_waiting 的写入发送唤醒字节；发送失败 (对端已退出或 socket 缓冲满) 时对端本来就会被唤醒
+    void wakePeer(ShmRingHeader& h) {
+        if (!std::atomic_ref<uint32_t>(h.reader_waiting).exchange(0, std::memory_order_relaxed)) return;
+        char c = 0;
+        ::send(ctl_fd_, &c, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    // 阻塞最多 timeout_ms 直到有数据、对端关闭或退出，返回是否就绪
+    bool waitData(int timeout_ms) {
+        bool ready = beginWait();
+        if (!ready && wait_fd(ctl_fd_, POLLIN, timeout_ms)) {
+            checkPeer();
+            ready = true;
+        }
+        endWait();
+        return ready;
+    }
+
+    void saveError(const char* msg, bool check_errno) {
+        if (check_errno)
+            snprintf(last_error_, sizeof(last_error_), "%s %s", msg, strerror(errno));
+        else
+            snprintf(last_error_, sizeof(last_error_), "%s", msg);
+    }
+
+    int ctl_fd_ = -1;
+    ShmRing tx_;
+    ShmRing rx_;
+    // 本端的写位置和上一次看到的对端读位置，空间不够时才重新读取共享的 read_pos
+    uint64_t tx_write_ = 0;
+    uint64_t tx_read_ = 0;
+    uint64_t rx_read_ = 0;
+    // 已经交给 handler 的 write_pos，没有新数据时不重复回调半包
+    uint64_t rx_seen_ = 0;
+    char last_error_[64] = "";
+};
+
+template <typename Conf>
+class SocketShmClient : public SocketShmConnection<Conf> {
+    static constexpr int64_t PeerCheckIntervalNs = 1000000000LL;
+
+   public:
+    using Conn = SocketShmConnection<Conf>;
+
+    ~SocketShmClient() {
+        if (conn_fd_ >= 0) ::close(conn_fd_);
+    }
+
+    // path 为 server 的 unix socket 路径
+    bool init(const char* path) {
+        snprintf(path_, sizeof(path_), "%s", path);
+        return true;
+    }
+
+    void allowReconnect() { next_conn_ts_ = 0; }
+
+    // 返回本次是否做了事: 连接建立/失败/断开、收到数据
+    template <typename Handler>
+    bool poll(Handler& handler) {
+        int64_t now = clock_now_ns<conf_clock<Conf>()>();
+        bool did_work = false;
+        if (!this->isConnected()) {
+            if (report_disconnect_) {
+                handler.onTcpDisconnect(*this);
+                report_disconnect_ = false;
+                did_work = true;
+            }
+            int ret = connect(now);
+            if (ret <= 0) {
+                if (ret < 0) handler.onTcpConnectFailed();
+                return did_work || ret < 0;
+            }
+            report_disconnect_ = true;
+            peer_check_ts_ = now;
+            handler.onTcpConnected(*this);
+            did_work = true;
+        }
+        if (now >= peer_check_ts_ + PeerCheckIntervalNs) {
+            peer_check_ts_ = now;
+            this->checkPeer();
+        }
+        if (this->isConnected()) did_work |= this->pollConn(handler);
+        return did_work || !this->isConnected();  // 断开在下一次 poll 报告
+    }
+
+    // 与 SocketTcpClient::wait 相同: 阻塞最多 timeout_ms 直到有数据、连接断开或建连的 hello 到达，返回是否就绪；
+    // 对端写入时若本端正阻塞在这里，会通过 unix socket 发一个字节唤醒。未连接且不在重连时只是 sleep
+    bool wait(int timeout_ms) {
+        if (this->isConnected()) return this->waitData(timeout_ms);
+        if (report_disconnect_) return true;
+        if (conn_fd_ >= 0) return wait_fd(conn_fd_, POLLIN, timeout_ms);
+        poll_fds(nullptr, 0, timeout_ms);
+        return false;
+    }
+
+   private:
+    int connect(int64_t now) {
+        if (conn_fd_ < 0) {
+            if (now < next_conn_ts_) return 0;
+            if (conf_conn_retry_ns<Conf>())
+                next_conn_ts_ = now + conf_conn_retry_ns<Conf>();
+            else
+                next_conn_ts_ = std::numeric_limits<int64_t>::max();
+
+            conn_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (conn_fd_ < 0) {
+                Conn::saveError("socket error", true);
+                return -1;
+            }
+            struct sockaddr_un addr;
+            socklen_t len = make_unix_addr(path_, addr);
+            if (::connect(conn_fd_, reinterpret_cast<struct sockaddr*>(&addr), len) < 0) {
+                return fail("connect error", true);
+            }
+            if (conf_conn_timeout_ns<Conf>())
+                conn_expire_ts_ = now + conf_conn_timeout_ns<Conf>();
+            else
+                conn_expire_ts_ = std::numeric_limits<int64_t>::max();
+        }
+
+        // 等待 server accept 后发来的 ShmHello 和两个 memfd
+        ShmHello hello;
+        struct iovec iov = {&hello, sizeof(hello)};
+        alignas(struct cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t n = ::recvmsg(conn_fd_, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (n < 0 && is_would_block(errno)) {
+            if (now < conn_expire_ts_) return 0;
+            return fail("connect expired", false);
+        }
+        if (n < 0) return fail("recvmsg error", true);
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+        if (n != sizeof(hello) || !cm || cm->cmsg_type != SCM_RIGHTS || cm->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+            return fail(n == 0 ? "remote close" : "bad hello", false);
+        }
+        int fds[2];
+        memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+        int ret = 1;
+        if (hello.magic != ShmHello::Magic || hello.ring_size != Conn::RingSize) {
+            ret = fail("shm ring size mismatch", false);
+        } else {
+            // fds[0] 为客户端到 server 的方向
+            if (!Conn::open(conn_fd_, fds[0], fds[1])) ret = -1;
+            conn_fd_ = -1;
+        }
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return ret;
+    }
+
+    int fail(const char* reason, bool check_errno) {
+        Conn::saveError(reason, check_errno);
+        ::close(conn_fd_);
+        conn_fd_ = -1;
+        return -1;
+    }
+
+    bool report_disconnect_ = false;
+    int conn_fd_ = -1;
+    int64_t next_conn_ts_ = 0;
+    int64_t conn_expire_ts_ = 0;
+    int64_t peer_check_ts_ = 0;
+    char path_[sizeof(sockaddr_un::sun_path)] = "";
+};
+
+template <typename Conf>
+class SocketShmServer {
+    static constexpr int64_t PeerCheckIntervalNs = 1000000000LL;
+
+   public:
+    using Conn = SocketShmConnection<Conf>;
+
+    // path 为 unix socket 路径，已存在的 socket 文件 (上次异常退出残留) 会被删除
+    bool init(const char* path) {
+        for (uint32_t i = 0; i < Conf::MaxConns; i++) conns_[i] = conns_data_ + i;
+        listenfd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenfd_ < 0) {
+            saveError("socket error");
+            return false;
+        }
+        struct sockaddr_un addr;
+        socklen_t len = make_unix_addr(path, addr);
+        if (path[0] != '@') ::unlink(path);
+        if (::bind(listenfd_, reinterpret_cast<struct sockaddr*>(&addr), len) < 0) {
+            close("bind error");
+            return false;
+        }
+        if (listen(listenfd_, conf_listen_backlog<Conf>()) < 0) {
+            close("listen error");
+            return false;
+        }
+        return true;
+    }
+
+    void close(const char* reason) {
+        if (listenfd_ >= 0) {
+            saveError(reason);
+            ::close(listenfd_);
+            listenfd_ = -1;
+        }
+    }
+
+    ~SocketShmServer() { close("destruct"); }
+
+    const char* getLastError() { return last_error_; }
+
+    bool isClosed() { return listenfd_ < 0; }
+
+    uint32_t getConnCnt() { return conns_cnt_; }
+
+    template <typename Handler>
+    void foreachConn(Handler handler) {
+        for (uint32_t i = 0; i < conns_cnt_; i++) handler(*conns_[i]);
+    }
+
+    // 返回本次是否做了事: 新连接、收到数据、断开
+    template <typename Handler>
+    bool poll(Handler& handler) {
+        bool did_work = accept(handler);
+        bool check_peer = false;
+        if (conns_cnt_) {
+            int64_t now = clock_now_ns<conf_clock<Conf>()>();
+            if (now >= peer_check_ts_ + PeerCheckIntervalNs) {
+                peer_check_ts_ = now;
+                check_peer = true;
+            }
+        }
+        for (uint32_t i = 0; i < conns_cnt_;) {
+            Conn& conn = *conns_[i];
+            if (check_peer && conn.isConnected()) conn.checkPeer();
+            if (conn.isConnected()) did_work |= conn.pollConn(handler);
+            if (conn.isConnected())
+                i++;
+            else {
+                std::swap(conns_[i], conns_[--conns_cnt_]);
+                handler.onTcpDisconnect(conn);
+                did_work = true;
+            }
+        }
+        return did_work;
+    }
+
+    // 与 SocketTcpServer::wait 相同: 阻塞最多 timeout_ms 直到有新连接、某个连接有数据或断开，返回是否就绪
+    bool wait(int timeout_ms) {
+        if (!pollfds_) pollfds_.reset(new struct pollfd[Conf::MaxConns + 1]);
+        bool ready = false;
+        uint32_t n = 0;
+        for (; n < conns_cnt_; n++) {
+            Conn& conn = *conns_[n];
+            // 已在外部关闭或已有数据，交给下一次 poll 处理
+            if (!conn.isConnected() || conn.beginWait()) {
+                if (conn.isConnected()) conn.endWait();
+                ready = true;
+                break;
+            }
+            pollfds_[n] = {conn.ctl_fd_, POLLIN, 0};
+        }
+        if (!ready) {
+            uint32_t cnt = n;
+            if (conns_cnt_ < Conf::MaxConns) pollfds_[cnt++] = {listenfd_, POLLIN, 0};
+            ready = poll_fds(pollfds_.get(), cnt, timeout_ms) > 0;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            Conn& conn = *conns_[i];
+            conn.endWait();
+            if (ready && pollfds_[i].revents) conn.checkPeer();
+        }
+        return ready;
+    }
+
+   private:
+    template <typename Handler>
+    bool accept(Handler& handler) {
+        uint32_t cnt = 0;
+        while (cnt < conf_max_accept_per_poll<Conf>() && conns_cnt_ < Conf::MaxConns) {
+            int fd = ::accept4(listenfd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) break;
+            cnt++;
+            Conn& conn = *conns_[conns_cnt_];
+            if (!handshake(conn, fd)) continue;
+            conns_cnt_++;
+            handler.onTcpConnected(conn);
+        }
+        return cnt > 0;
+    }
+
+    // 创建 c2s/s2c 两块 memfd，连同 ShmHello 一起发给客户端；失败时关闭 fd
+    bool handshake(Conn& conn, int fd) {
+        int fds[2] = {ShmRing::create(Conn::RingSize), ShmRing::create(Conn::RingSize)};
+        bool ok = fds[0] >= 0 && fds[1] >= 0;
+        if (ok) {
+            ShmHello hello = {ShmHello::Magic, Conn::RingSize};
+            struct iovec iov = {&hello, sizeof(hello)};
+            alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = SOL_SOCKET;
+            cm->cmsg_type = SCM_RIGHTS;
+            cm->cmsg_len = CMSG_LEN(sizeof(fds));
+            memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+            if (::sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(hello)) {
+                ok = conn.open(fd, fds[1], fds[0]);
+            } else {
+                conn.saveError("sendmsg hello error", true);
+                ::close(fd);
+                ok = false;
+            }
+        } else {
+            conn.saveError("memfd_create error", true);
+            ::close(fd);
+        }
+        for (int f : fds)
+            if (f >= 0) ::close(f);
+        return ok;
+    }
+
+    void saveError(const char* msg) { snprintf(last_error_, sizeof(last_error_), "%s %s", msg, strerror(errno)); }
+
+    int listenfd_ = -1;
+    int64_t peer_check_ts_ = 0;
+    uint32_t conns_cnt_ = 0;
+    Conn* conns_[Conf::MaxConns];
+    Conn conns_data_[Conf::MaxConns];
+    // wait 时使用，第一次调用时分配
+    std::unique_ptr<struct pollfd[]> pollfds_;
+    char last_error_[64] = "";
+};
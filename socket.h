@@ -20,19 +20,40 @@ inline bool is_would_block(int err) { return err == WSAEWOULDBLOCK; }
 inline bool is_in_progress(int err) { return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS || err == WSAEALREADY; }
 inline bool is_isconn(int err) { return err == WSAEISCONN; }
 inline void close_socket(socket_t s) { closesocket(s); }
+
+// 与 POSIX 相同的分散/聚集缓冲描述，Windows 下 writev 逐段 send
+struct iovec {
+    void* iov_base;
+    size_t iov_len;
+};
 #else
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
 #include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <netinet/ip.h>
 #include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <cerrno>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "uring.h"
 
 using socket_t = int;
 constexpr socket_t INVALID_SOCKET_FD = -1;
@@ -43,13 +64,38 @@ inline bool is_would_block(int err) { return err == EAGAIN || err == EWOULDBLOCK
 inline bool is_in_progress(int err) { return err == EINPROGRESS || err == EALREADY; }
 inline bool is_isconn(int err) { return err == EISCONN; }
 inline void close_socket(socket_t s) { ::close(s); }
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#include "idle_strategy.h"
+#include "msg_queue.h"
+#include "timer_wheel.h"
 
 // C++20 线程安全的全局 WSA 初始化助手
 inline void ensure_network_init() {
@@ -74,12 +120,744 @@ inline bool set_nonblocking(socket_t fd) {
 #endif
 }
 
+// 阻塞等待 fds 中任意一个就绪，返回就绪的个数，超时为 0；n 为 0 时相当于 sleep
+inline int poll_fds(struct pollfd* fds, uint32_t n, int timeout_ms) {
+#ifdef _WIN32
+    if (n == 0) {
+        Sleep(timeout_ms);
+        return 0;
+    }
+    return WSAPoll(fds, n, timeout_ms);
+#else
+    return ::poll(fds, n, timeout_ms);
+#endif
+}
+
+inline bool wait_fd(socket_t fd, short events, int timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+    return poll_fds(&pfd, 1, timeout_ms) > 0;
+}
+
+#ifndef _WIN32
+// SO_BUSY_POLL: 读 socket 或 poll/select 时先在网卡队列 (NAPI) 上忙轮询最多 usec 微秒，跳过中断和软中断的唤醒延迟；
+// 非阻塞 recv 也会顺带轮询一次。prefer 为 SO_PREFER_BUSY_POLL，忙轮询期间抑制网卡中断
+// (需配合 napi_defer_hard_irqs/gro_flush_timeout)。超过 net.core.busy_read 的值和 prefer 都需要 CAP_NET_ADMIN
+inline bool set_busy_poll(socket_t fd, uint32_t usec, bool prefer) {
+    int val = usec;
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val)) < 0) return false;
+    val = prefer;
+    return !prefer || setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &val, sizeof(val)) == 0;
+}
+
+// 填充 AF_UNIX 地址，返回地址长度；path 以 '@' 开头时使用 abstract namespace，不在文件系统中留下 socket 文件
+inline socklen_t make_unix_addr(const char* path, struct sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    size_t len = std::min(strlen(path), sizeof(addr.sun_path) - 1);
+    memcpy(addr.sun_path, path, len);
+    if (path[0] == '@') {
+        addr.sun_path[0] = '\0';
+        return offsetof(struct sockaddr_un, sun_path) + len;
+    }
+    return sizeof(addr);
+}
+#endif
+
+// 事件后端: Scan 为原始的逐连接 recv 轮询，Epoll* 仅处理内核报告就绪的连接，
+// IoUring 使用 multishot accept/recv + provided buffer ring，初始化失败时退回 Scan (仅 Linux)
+enum class PollBackend {
+    Scan,
+    EpollLevel,
+    EpollEdge,
+    IoUring,
+};
+
+// Conf 中的可选项，未定义时取默认值，保持旧的 Conf 可以直接编译
+template <typename Conf>
+constexpr PollBackend conf_backend() {
+    if constexpr (requires { Conf::Backend; })
+        return Conf::Backend;
+    else
+        return PollBackend::Scan;
+}
+
+template <typename Conf>
+constexpr uint32_t conf_max_events() {
+    if constexpr (requires { Conf::MaxEvents; })
+        return Conf::MaxEvents;
+    else
+        return 64;
+}
+
+// listen 的 backlog，内核会截断到 net.core.somaxconn；大量客户端同时重连时太小会导致 SYN 被丢弃、退避重传
+template <typename Conf>
+constexpr int conf_listen_backlog() {
+    if constexpr (requires { Conf::ListenBacklog; })
+        return Conf::ListenBacklog;
+    else
+        return SOMAXCONN;
+}
+
+// Scan/epoll 后端每次 poll 最多 accept 的连接数，一次取完积压的连接而不挤占已有连接的处理
+template <typename Conf>
+constexpr uint32_t conf_max_accept_per_poll() {
+    if constexpr (requires { Conf::MaxAcceptPerPoll; })
+        return Conf::MaxAcceptPerPoll;
+    else
+        return 64;
+}
+
+// server.reply 使用的回复队列 (工作线程 -> poll 线程的 MPSC 队列) 长度，2 的幂，0 表示不开启
+template <typename Conf>
+constexpr uint32_t conf_reply_queue_len() {
+    if constexpr (requires { Conf::ReplyQueueLen; })
+        return Conf::ReplyQueueLen;
+    else
+        return 0;
+}
+
+// 单条回复的最大字节数，回复队列每个槽位固定占用这么多
+template <typename Conf>
+constexpr uint32_t conf_reply_max_size() {
+    if constexpr (requires { Conf::ReplyMaxSize; })
+        return Conf::ReplyMaxSize;
+    else
+        return 1024;
+}
+
+// 地址族: Inet 为 TCP/IPv4；Unix 为 AF_UNIX 流式 socket (仅 Linux)，同机通信不经过 TCP/IP 协议栈，
+// 此时 init 的 server_ip 为 socket 路径，端口被忽略
+enum class AddressFamily {
+    Inet,
+    Unix,
+};
+
+template <typename Conf>
+constexpr AddressFamily conf_family() {
+    if constexpr (requires { Conf::Family; })
+        return Conf::Family;
+    else
+        return AddressFamily::Inet;
+}
+
+// io_uring provided buffer 数量，必须是 2 的幂，每个 buffer 大小为 RecvBufSize
+template <typename Conf>
+constexpr uint32_t conf_uring_buf_cnt() {
+    if constexpr (requires { Conf::UringBufCnt; })
+        return Conf::UringBufCnt;
+    else
+        return 256;
+}
+
+// 每个连接的发送队列大小 (2 的幂)，0 表示不排队 (write 在发送缓冲满时自旋，writeNonblock 直接断开)
+template <typename Conf>
+constexpr uint32_t conf_send_buf_size() {
+    if constexpr (requires { Conf::SendBufSize; })
+        return Conf::SendBufSize;
+    else
+        return 0;
+}
+
+// 发送队列积压超过高水位时回调 onSendHighWatermark，之后降到低水位以下时回调 onSendLowWatermark
+template <typename Conf>
+constexpr uint32_t conf_send_high_watermark() {
+    if constexpr (requires { Conf::SendHighWatermark; })
+        return Conf::SendHighWatermark;
+    else
+        return conf_send_buf_size<Conf>() / 4 * 3;
+}
+
+template <typename Conf>
+constexpr uint32_t conf_send_low_watermark() {
+    if constexpr (requires { Conf::SendLowWatermark; })
+        return Conf::SendLowWatermark;
+    else
+        return conf_send_buf_size<Conf>() / 4;
+}
+
+// 每个连接的发送队列中最多引用的 broadcast 共享数据个数，默认配置了 SendBufSize 时为 16
+template <typename Conf>
+constexpr uint32_t conf_broadcast_queue_len() {
+    if constexpr (requires { Conf::BroadcastQueueLen; })
+        return Conf::BroadcastQueueLen;
+    else
+        return conf_send_buf_size<Conf>() ? 16 : 0;
+}
+
+// server 中同时存在的 broadcast 共享数据的最大个数，按需分配，默认 2 倍 BroadcastQueueLen
+template <typename Conf>
+constexpr uint32_t conf_broadcast_buf_cnt() {
+    if constexpr (requires { Conf::BroadcastBufCnt; })
+        return Conf::BroadcastBufCnt;
+    else
+        return conf_broadcast_queue_len<Conf>() * 2;
+}
+
+// broadcast 时发送队列放不下的慢连接: Disconnect 断开，Drop 跳过这条数据 (对端少收一条完整的消息)
+enum class SlowConsumerPolicy {
+    Disconnect,
+    Drop,
+};
+
+template <typename Conf>
+constexpr SlowConsumerPolicy conf_slow_consumer() {
+    if constexpr (requires { Conf::SlowConsumer; })
+        return Conf::SlowConsumer;
+    else
+        return SlowConsumerPolicy::Disconnect;
+}
+
+// writeZeroCopy 使用 MSG_ZEROCOPY 的最小字节数，0 表示关闭零拷贝 (仅 Linux)
+template <typename Conf>
+constexpr uint32_t conf_zero_copy_threshold() {
+    if constexpr (requires { Conf::ZeroCopyThreshold; })
+        return Conf::ZeroCopyThreshold;
+    else
+        return 0;
+}
+
+// 时钟: poll 开始时读一次，以纳秒传给各连接，写操作直接使用这个时间戳。
+// Coarse 为 CLOCK_MONOTONIC_COARSE (精度为一个 tick，最便宜)，Monotonic 为 vDSO CLOCK_MONOTONIC，
+// Tsc 为校准过的 rdtsc (非 x86 时退回 Monotonic)；Windows 下都使用 steady_clock
+enum class ClockSource {
+    Coarse,
+    Monotonic,
+    Tsc,
+};
+
+template <typename Conf>
+constexpr ClockSource conf_clock() {
+    if constexpr (requires { Conf::Clock; })
+        return Conf::Clock;
+    else
+        return ClockSource::Coarse;
+}
+
+#ifndef _WIN32
+inline int64_t clock_gettime_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+#endif
+
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+// 第一次使用时对照 CLOCK_MONOTONIC 校准 10ms 得到 TSC 频率，要求 constant/invariant TSC
+class TscClock {
+   public:
+    static int64_t now() {
+        static const TscClock clock;
+        return clock.base_ns_ + static_cast<int64_t>(static_cast<double>(__rdtsc() - clock.base_tsc_) * clock.ns_per_tick_);
+    }
+
+   private:
+    TscClock() {
+        int64_t ns0 = clock_gettime_ns(CLOCK_MONOTONIC);
+        uint64_t tsc0 = __rdtsc();
+        int64_t ns1;
+        do {
+            ns1 = clock_gettime_ns(CLOCK_MONOTONIC);
+        } while (ns1 - ns0 < 10000000);
+        uint64_t tsc1 = __rdtsc();
+        ns_per_tick_ = static_cast<double>(ns1 - ns0) / static_cast<double>(tsc1 - tsc0);
+        base_ns_ = ns1;
+        base_tsc_ = tsc1;
+    }
+
+    int64_t base_ns_;
+    uint64_t base_tsc_;
+    double ns_per_tick_;
+};
+#endif
+
+template <ClockSource Clock>
+inline int64_t clock_now_ns() {
+#ifdef _WIN32
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#else
+    if constexpr (Clock == ClockSource::Coarse) return clock_gettime_ns(CLOCK_MONOTONIC_COARSE);
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (Clock == ClockSource::Tsc) return TscClock::now();
+#endif
+    return clock_gettime_ns(CLOCK_MONOTONIC);
+#endif
+}
+
+// 收包时间戳 (SO_TIMESTAMPING): Software 为内核协议栈收到包的时间，Hardware 额外请求网卡打的时间戳，
+// 需要事先用 SIOCSHWTSTAMP (如 hwstamp_ctl) 打开网卡的硬件时间戳，网卡不支持时 hw_ns 为 0 (仅 Linux)
+enum class TimestampMode {
+    None,
+    Software,
+    Hardware,
+};
+
+template <typename Conf>
+constexpr TimestampMode conf_timestamping() {
+    if constexpr (requires { Conf::Timestamping; })
+        return Conf::Timestamping;
+    else
+        return TimestampMode::None;
+}
+
+// 连接上的 SO_BUSY_POLL 微秒数 (0 为不开启) 和 SO_PREFER_BUSY_POLL，见 set_busy_poll (仅 Linux)
+template <typename Conf>
+constexpr uint32_t conf_busy_poll_us() {
+    if constexpr (requires { Conf::BusyPollUs; })
+        return Conf::BusyPollUs;
+    else
+        return 0;
+}
+
+template <typename Conf>
+constexpr bool conf_prefer_busy_poll() {
+    if constexpr (requires { Conf::PreferBusyPoll; })
+        return Conf::PreferBusyPoll;
+    else
+        return false;
+}
+
+// CLOCK_REALTIME 纳秒，0 表示没有；与 realtime_now_ns() 相减即为内核 (或网卡) 到用户态的延迟
+struct RxTimestamp {
+    int64_t sw_ns = 0;
+    int64_t hw_ns = 0;
+};
+
+#ifndef _WIN32
+inline int64_t realtime_now_ns() { return clock_gettime_ns(CLOCK_REALTIME); }
+
+constexpr uint32_t RxTimestampControlSize = CMSG_SPACE(sizeof(struct scm_timestamping));
+
+inline bool set_rx_timestamping(socket_t fd, TimestampMode mode) {
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (mode == TimestampMode::Hardware) flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+}
+
+// ts[0] 为软件时间戳，ts[2] 为网卡原始时间戳
+inline void parse_rx_timestamp(struct msghdr& msg, RxTimestamp& ts) {
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping t;
+            memcpy(&t, CMSG_DATA(cm), sizeof(t));
+            ts.sw_ns = t.ts[0].tv_sec * 1000000000LL + t.ts[0].tv_nsec;
+            ts.hw_ns = t.ts[2].tv_sec * 1000000000LL + t.ts[2].tv_nsec;
+            return;
+        }
+    }
+}
+#endif
+
+// 超时配置统一换算成纳秒: XxxMs 优先于 XxxSec，都未定义时为 0 (不检查)
+template <typename Conf>
+constexpr int64_t conf_send_timeout_ns() {
+    if constexpr (requires { Conf::SendTimeoutMs; })
+        return Conf::SendTimeoutMs * 1000000LL;
+    else if constexpr (requires { Conf::SendTimeoutSec; })
+        return Conf::SendTimeoutSec * 1000000000LL;
+    else
+        return 0;
+}
+
+template <typename Conf>
+constexpr int64_t conf_recv_timeout_ns() {
+    if constexpr (requires { Conf::RecvTimeoutMs; })
+        return Conf::RecvTimeoutMs * 1000000LL;
+    else if constexpr (requires { Conf::RecvTimeoutSec; })
+        return Conf::RecvTimeoutSec * 1000000000LL;
+    else
+        return 0;
+}
+
+template <typename Conf>
+constexpr int64_t conf_conn_timeout_ns() {
+    if constexpr (requires { Conf::ConnTimeoutMs; })
+        return Conf::ConnTimeoutMs * 1000000LL;
+    else if constexpr (requires { Conf::ConnTimeoutSec; })
+        return Conf::ConnTimeoutSec * 1000000000LL;
+    else
+        return 0;
+}
+
+template <typename Conf>
+constexpr int64_t conf_conn_retry_ns() {
+    if constexpr (requires { Conf::ConnRetryMs; })
+        return Conf::ConnRetryMs * 1000000LL;
+    else if constexpr (requires { Conf::ConnRetrySec; })
+        return Conf::ConnRetrySec * 1000000000LL;
+    else
+        return 0;
+}
+
+// 每个 server/client 最多同时存在的 addTimer 定时器数量
+template <typename Conf>
+constexpr uint32_t conf_max_timers() {
+    if constexpr (requires { Conf::MaxTimers; })
+        return Conf::MaxTimers;
+    else
+        return 1024;
+}
+
+// 接收缓冲: Inline 为连接内的数组，半包超过一半时 memmove 到开头；
+// Mirrored 为双重映射的环形缓冲 (仅 Linux，RecvBufSize 须为页大小的整数倍)，半包总是连续且不需要搬移；
+// Spill 在内联数组装不下一条消息时从共享池借一块 SpillBufSize 的大缓冲，消息处理完后归还
+enum class RecvBufMode {
+    Inline,
+    Mirrored,
+    Spill,
+};
+
+template <typename Conf>
+constexpr RecvBufMode conf_recv_buf_mode() {
+    if constexpr (requires { Conf::RecvBuf; })
+        return Conf::RecvBuf;
+    else
+        return RecvBufMode::Inline;
+}
+
+template <typename Conf>
+constexpr uint32_t conf_spill_buf_size() {
+    if constexpr (requires { Conf::SpillBufSize; })
+        return Conf::SpillBufSize;
+    else
+        return Conf::RecvBufSize * 16;
+}
+
+template <typename Conf>
+constexpr uint32_t conf_spill_buf_cnt() {
+    if constexpr (requires { Conf::SpillBufCnt; })
+        return Conf::SpillBufCnt;
+    else
+        return 16;
+}
+
+// ==========================================
+// 统计计数 (Conf::Stats / 模板参数 Stats 开启)
+// ==========================================
+
+template <typename Conf>
+constexpr bool conf_stats() {
+    if constexpr (requires { Conf::Stats; })
+        return Conf::Stats;
+    else
+        return false;
+}
+
+// 计数快照，getStats() 的返回值
+struct SocketStats {
+    static constexpr uint32_t HistBuckets = 32;
+
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    uint64_t msgs_in = 0;         // TCP 为收到数据的 recv/CQE 次数，UDP 为数据报个数
+    uint64_t msgs_out = 0;        // TCP 为发出数据的 send 次数，UDP 为数据报个数
+    uint64_t recv_eagain = 0;     // 返回 EAGAIN 的接收调用
+    uint64_t partial_writes = 0;  // 没有全部发出 (含 EAGAIN) 的发送调用
+    uint64_t compactions = 0;     // 接收缓冲中半包 memmove 到开头的次数
+    uint64_t recv_buf_hwm = 0;    // 接收缓冲中最多积压的字节数，UDP 为单次收到的最大字节数
+    uint64_t send_buf_hwm = 0;    // 发送队列最多积压的字节数
+    // handler 回调耗时分布: 桶 0 为 0ns，桶 i 为 [2^(i-1), 2^i) ns，最后一个桶包含所有更长的
+    uint64_t handler_ns[HistBuckets] = {};
+
+    uint64_t handlerCnt() const {
+        uint64_t cnt = 0;
+        for (uint64_t n : handler_ns) cnt += n;
+        return cnt;
+    }
+
+    // 返回 p (0~1) 分位所在桶的上界 (ns)，没有样本时为 0
+    uint64_t handlerPercentileNs(double p) const {
+        uint64_t cnt = handlerCnt();
+        if (cnt == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * cnt + 0.5));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < HistBuckets; i++) {
+            seen += handler_ns[i];
+            if (seen >= rank) return i ? (uint64_t{1} << i) - 1 : 0;
+        }
+        return (uint64_t{1} << (HistBuckets - 1)) - 1;
+    }
+
+    // 合并多个连接/shard 的快照，高水位取最大值
+    SocketStats& operator+=(const SocketStats& o) {
+        bytes_in += o.bytes_in;
+        bytes_out += o.bytes_out;
+        msgs_in += o.msgs_in;
+        msgs_out += o.msgs_out;
+        recv_eagain += o.recv_eagain;
+        partial_writes += o.partial_writes;
+        compactions += o.compactions;
+        recv_buf_hwm = std::max(recv_buf_hwm, o.recv_buf_hwm);
+        send_buf_hwm = std::max(send_buf_hwm, o.send_buf_hwm);
+        for (uint32_t i = 0; i < HistBuckets; i++) handler_ns[i] += o.handler_ns[i];
+        return *this;
+    }
+};
+
+// 单写者: 只有所属的 poll 线程写，用 relaxed 的 load + store 代替 fetch_add (x86 上就是普通的 mov)；
+// 其他线程随时可以用 snapshot() 无锁读取，各字段不保证取自同一时刻。独占 cache line，不和热路径上的字段共享
+template <bool Enabled>
+class alignas(64) SocketStatsRecorder {
+   public:
+    // handler 计时固定使用 TSC (非 x86 时为 CLOCK_MONOTONIC)，构造时完成校准
+    SocketStatsRecorder() { clock_now_ns<ClockSource::Tsc>(); }
+
+    void received(uint64_t bytes, uint64_t msgs = 1) {
+        add(s_.bytes_in, bytes);
+        add(s_.msgs_in, msgs);
+    }
+    void sent(uint64_t bytes, uint64_t msgs = 1) {
+        add(s_.bytes_out, bytes);
+        add(s_.msgs_out, msgs);
+    }
+    void recvEagain() { add(s_.recv_eagain, 1); }
+    void partialWrite() { add(s_.partial_writes, 1); }
+    void compaction() { add(s_.compactions, 1); }
+    void recvBuffered(uint64_t bytes) { max(s_.recv_buf_hwm, bytes); }
+    void sendQueued(uint64_t bytes) { max(s_.send_buf_hwm, bytes); }
+
+    int64_t handlerBegin() { return clock_now_ns<ClockSource::Tsc>(); }
+    void handlerEnd(int64_t begin) {
+        int64_t ns = clock_now_ns<ClockSource::Tsc>() - begin;
+        uint32_t idx = ns > 0 ? std::bit_width(static_cast<uint64_t>(ns)) : 0;
+        add(s_.handler_ns[std::min(idx, SocketStats::HistBuckets - 1)], 1);
+    }
+
+    SocketStats snapshot() const {
+        SocketStats r;
+        r.bytes_in = load(s_.bytes_in);
+        r.bytes_out = load(s_.bytes_out);
+        r.msgs_in = load(s_.msgs_in);
+        r.msgs_out = load(s_.msgs_out);
+        r.recv_eagain = load(s_.recv_eagain);
+        r.partial_writes = load(s_.partial_writes);
+        r.compactions = load(s_.compactions);
+        r.recv_buf_hwm = load(s_.recv_buf_hwm);
+        r.send_buf_hwm = load(s_.send_buf_hwm);
+        for (uint32_t i = 0; i < SocketStats::HistBuckets; i++) r.handler_ns[i] = load(s_.handler_ns[i]);
+        return r;
+    }
+
+    // 把另一份快照累加进来 (server 复用连接槽位时收走旧连接的计数)
+    void merge(const SocketStats& o) {
+        add(s_.bytes_in, o.bytes_in);
+        add(s_.bytes_out, o.bytes_out);
+        add(s_.msgs_in, o.msgs_in);
+        add(s_.msgs_out, o.msgs_out);
+        add(s_.recv_eagain, o.recv_eagain);
+        add(s_.partial_writes, o.partial_writes);
+        add(s_.compactions, o.compactions);
+        max(s_.recv_buf_hwm, o.recv_buf_hwm);
+        max(s_.send_buf_hwm, o.send_buf_hwm);
+        for (uint32_t i = 0; i < SocketStats::HistBuckets; i++) add(s_.handler_ns[i], o.handler_ns[i]);
+    }
+
+    void reset() {
+        uint64_t* p = &s_.bytes_in;
+        for (uint32_t i = 0; i < sizeof(s_) / sizeof(uint64_t); i++)
+            std::atomic_ref<uint64_t>(p[i]).store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    static void add(uint64_t& v, uint64_t n) { std::atomic_ref<uint64_t>(v).store(v + n, std::memory_order_relaxed); }
+    static void max(uint64_t& v, uint64_t n) {
+        if (n > v) std::atomic_ref<uint64_t>(v).store(n, std::memory_order_relaxed);
+    }
+    static uint64_t load(const uint64_t& v) {
+        return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(v)).load(std::memory_order_relaxed);
+    }
+
+    SocketStats s_;
+};
+
+// 关闭时所有调用都是空函数，成员用 [[no_unique_address]] 声明，不占空间
+template <>
+class SocketStatsRecorder<false> {
+   public:
+    void received(uint64_t, uint64_t = 1) {}
+    void sent(uint64_t, uint64_t = 1) {}
+    void recvEagain() {}
+    void partialWrite() {}
+    void compaction() {}
+    void recvBuffered(uint64_t) {}
+    void sendQueued(uint64_t) {}
+    int64_t handlerBegin() { return 0; }
+    void handlerEnd(int64_t) {}
+    SocketStats snapshot() const { return {}; }
+    void merge(const SocketStats&) {}
+    void reset() {}
+};
+
+// 多个连接共享的大缓冲池，第一次用到时才分配，内存随同时在收的大消息数量增长，最多 max_cnt 块
+class SpillPool {
+   public:
+    SpillPool(uint32_t buf_size, uint32_t max_cnt)
+        : buf_size_(buf_size),
+          max_cnt_(max_cnt),
+          bufs_(std::make_unique<std::unique_ptr<uint8_t[]>[]>(max_cnt)),
+          free_(std::make_unique<uint8_t*[]>(max_cnt)) {}
+
+    // 池已耗尽时返回 nullptr
+    uint8_t* acquire() {
+        if (free_cnt_) return free_[--free_cnt_];
+        if (alloc_cnt_ == max_cnt_) return nullptr;
+        bufs_[alloc_cnt_] = std::make_unique_for_overwrite<uint8_t[]>(buf_size_);
+        return bufs_[alloc_cnt_++].get();
+    }
+
+    void release(uint8_t* buf) { free_[free_cnt_++] = buf; }
+
+    uint32_t inUse() { return alloc_cnt_ - free_cnt_; }
+
+   private:
+    uint32_t buf_size_;
+    uint32_t max_cnt_;
+    uint32_t alloc_cnt_ = 0;
+    uint32_t free_cnt_ = 0;
+    std::unique_ptr<std::unique_ptr<uint8_t[]>[]> bufs_;
+    std::unique_ptr<uint8_t*[]> free_;
+};
+
+// broadcast 的共享数据: 只拷贝一次，被多个连接的发送队列引用，引用计数归零时回到池中
+struct SharedPayload {
+    uint32_t refs = 0;
+    uint32_t size = 0;
+    uint32_t cap = 0;
+    std::unique_ptr<uint8_t[]> data;
+};
+
+// 最多 max_cnt 个 payload，第一次用到时才分配，之后复用 (容量不够时重新分配)
+class SharedPayloadPool {
+   public:
+    explicit SharedPayloadPool(uint32_t max_cnt)
+        : max_cnt_(max_cnt),
+          payloads_(std::make_unique<SharedPayload[]>(max_cnt)),
+          free_(std::make_unique<SharedPayload*[]>(max_cnt)) {}
+
+    // 拷贝 data 并返回 refs 为 0 的 payload，池已耗尽时返回 nullptr
+    SharedPayload* acquire(const void* data, uint32_t size) {
+        SharedPayload* p;
+        if (free_cnt_)
+            p = free_[--free_cnt_];
+        else if (alloc_cnt_ < max_cnt_)
+            p = &payloads_[alloc_cnt_++];
+        else
+            return nullptr;
+        if (p->cap < size) {
+            p->data = std::make_unique_for_overwrite<uint8_t[]>(size);
+            p->cap = size;
+        }
+        memcpy(p->data.get(), data, size);
+        p->size = size;
+        p->refs = 0;
+        return p;
+    }
+
+    void release(SharedPayload* p) { free_[free_cnt_++] = p; }
+
+    uint32_t inUse() { return alloc_cnt_ - free_cnt_; }
+
+   private:
+    uint32_t max_cnt_;
+    uint32_t alloc_cnt_ = 0;
+    uint32_t free_cnt_ = 0;
+    std::unique_ptr<SharedPayload[]> payloads_;
+    std::unique_ptr<SharedPayload*[]> free_;
+};
+
+#ifndef _WIN32
+// 同一块 memfd 内存被连续映射两次，[data, data + size) 之后紧接着又是它自己，
+// 从任意位置开始、长度不超过 size 的读写都是连续的
+class MirrorBuffer {
+   public:
+    ~MirrorBuffer() { release(); }
+
+    bool init(uint32_t size) {
+        if (data_) return true;
+        if (size % sysconf(_SC_PAGESIZE)) {
+            errno = EINVAL;
+            return false;
+        }
+        int fd = memfd_create("pollnet_mirror", MFD_CLOEXEC);
+        if (fd < 0) return false;
+        if (ftruncate(fd, size) < 0) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, 2 * static_cast<size_t>(size), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        uint8_t* base = static_cast<uint8_t*>(p);
+        if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(base, 2 * static_cast<size_t>(size));
+            ::close(fd);
+            return false;
+        }
+        ::close(fd);
+        data_ = base;
+        size_ = size;
+        return true;
+    }
+
+    void release() {
+        if (data_) munmap(data_, 2 * static_cast<size_t>(size_));
+        data_ = nullptr;
+    }
+
+    uint8_t* data() { return data_; }
+
+   private:
+    uint8_t* data_ = nullptr;
+    uint32_t size_ = 0;
+};
+#endif
+
 // ==========================================
 // 业务逻辑实现 (Business Logic)
 // ==========================================
 
+template <typename Conf>
+class SocketTcpServer;
+
+template <typename Conf>
+class SocketTimers;
+
 template <typename Conf>
 class SocketTcpConnection : public Conf::UserData {
+    static constexpr uint32_t SendBufSize = conf_send_buf_size<Conf>();
+    // 队列位置是不清零的 uint32_t 计数，回绕时取模要保持连续，所以必须是 2 的幂
+    static_assert((SendBufSize & (SendBufSize - 1)) == 0, "SendBufSize must be a power of 2");
+    static constexpr uint32_t BroadcastQueueLen = conf_broadcast_queue_len<Conf>();
+    static constexpr uint32_t BroadcastSlots = BroadcastQueueLen ? BroadcastQueueLen : 1;
+    static constexpr uint32_t ZeroCopyThreshold = conf_zero_copy_threshold<Conf>();
+    static constexpr uint32_t ZeroCopyMaxPending = 64;
+    static constexpr int64_t SendTimeoutNs = conf_send_timeout_ns<Conf>();
+    static constexpr int64_t RecvTimeoutNs = conf_recv_timeout_ns<Conf>();
+    static constexpr bool Mirrored = conf_recv_buf_mode<Conf>() == RecvBufMode::Mirrored;
+    static constexpr bool Spill = conf_recv_buf_mode<Conf>() == RecvBufMode::Spill;
+    static constexpr uint32_t SpillBufSize = conf_spill_buf_size<Conf>();
+    static constexpr bool Stats = conf_stats<Conf>();
+    static constexpr TimestampMode Timestamping = conf_timestamping<Conf>();
+    static constexpr uint32_t BusyPollUs = conf_busy_poll_us<Conf>();
+    static constexpr bool PreferBusyPoll = conf_prefer_busy_poll<Conf>();
+    static constexpr bool Unix = conf_family<Conf>() == AddressFamily::Unix;
+    static_assert(!Spill || SpillBufSize > Conf::RecvBufSize, "SpillBufSize must be larger than RecvBufSize");
+    // AF_UNIX 不支持 MSG_ZEROCOPY 和 SO_TIMESTAMPING
+    static_assert(!Unix || (ZeroCopyThreshold == 0 && Timestamping == TimestampMode::None),
+                  "zero copy and rx timestamping are not available on unix sockets");
+#ifdef _WIN32
+    static_assert(!Unix, "unix socket is only available on Linux");
+    static_assert(!Mirrored, "mirrored recv buffer is only available on Linux");
+    static_assert(Timestamping == TimestampMode::None, "rx timestamping is only available on Linux");
+    static_assert(BusyPollUs == 0 && !PreferBusyPoll, "busy poll is only available on Linux");
+#endif
+
    public:
     ~SocketTcpConnection() { close("destruct"); }
 
@@ -87,7 +865,12 @@ class SocketTcpConnection : public Conf::UserData {
 
     bool isConnected() { return fd_ != INVALID_SOCKET_FD; }
 
-    bool getPeername(struct sockaddr_in& addr) {
+    // Conf::Stats 为 true 时有效，可以在其他线程调用；client 重连后继续累计
+    SocketStats getStats() const { return stats_.snapshot(); }
+
+    // Addr 为 sockaddr_in 或 sockaddr_un，与 Conf::Family 对应
+    template <typename Addr>
+    bool getPeername(Addr& addr) {
         socklen_t addr_len = sizeof(addr);
         return ::getpeername(fd_, (struct sockaddr*)&addr, &addr_len) == 0;
     }
@@ -97,7 +880,12 @@ class SocketTcpConnection : public Conf::UserData {
             saveError(reason, check_errno);
             close_socket(fd_);
             fd_ = INVALID_SOCKET_FD;
+            if (on_closed_) on_closed_(owner_, *this);
         }
+        if (spill_) releaseSpill();
+        if (bcast_cnt_) releaseBroadcast();
+        if (recv_timer_.isArmed()) wheel_->cancel(recv_timer_);
+        if (send_timer_.isArmed()) wheel_->cancel(send_timer_);
     }
 
     int writeSome(const void* data, uint32_t size, bool more = false) {
@@ -114,12 +902,84 @@ class SocketTcpConnection : public Conf::UserData {
             else
                 close("send error", true);
         }
-        if (Conf::SendTimeoutSec) send_ts_ = time(0);
+        if (SendTimeoutNs) send_ts_ = wheel_->now();
+        recordSend(ret, size);
+        return ret;
+    }
+
+    // 一次 sendmsg 发出多段数据 (如 header + body)，返回发出的字节数，出错返回 -1
+    int writevSome(std::span<const struct iovec> iov, bool more = false) {
+#ifndef _WIN32
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(iov.data());
+        msg.msg_iovlen = iov.size();
+        int flags = MSG_NOSIGNAL;
+        if (more) flags |= MSG_MORE;
+        int ret = ::sendmsg(fd_, &msg, flags);
+#else
+        int ret = 0;
+        for (const struct iovec& v : iov) {
+            int n = ::send(fd_, reinterpret_cast<const char*>(v.iov_base), static_cast<int>(v.iov_len), 0);
+            if (n < 0) {
+                if (ret == 0) ret = -1;
+                break;
+            }
+            ret += n;
+            if (n < static_cast<int>(v.iov_len)) break;
+        }
+#endif
+        if (ret < 0) {
+            if (is_would_block(get_last_error()))
+                ret = 0;
+            else
+                close("send error", true);
+        }
+        if (SendTimeoutNs) send_ts_ = wheel_->now();
+        if constexpr (Stats) {
+            uint64_t total = 0;
+            for (const struct iovec& v : iov) total += v.iov_len;
+            recordSend(ret, total);
+        }
         return ret;
     }
 
+    // 最多 MaxIov 段，超过时返回 false 且连接保持打开 (getLastError 为 "too many iovecs")；部分发送时跳过已发出的段继续发送
+    static constexpr uint32_t MaxIov = 64;
+
+    bool writev(std::span<const struct iovec> iov, bool more = false) {
+        struct iovec local[MaxIov];
+        size_t cnt = iov.size();
+        uint64_t total = copyIov(iov, local);
+        if (total == UINT64_MAX) return false;
+        if constexpr (SendBufSize > 0) return writevQueued(local, cnt, total, more);
+        struct iovec* cur = local;
+        while (true) {
+            int sent = writevSome({cur, cnt}, more);
+            if (sent < 0) return false;
+            total -= sent;
+            if (total == 0) return true;
+            advanceIov(cur, cnt, sent);
+        }
+    }
+
+    bool writevNonblock(std::span<const struct iovec> iov, bool more = false) {
+        struct iovec local[MaxIov];
+        size_t cnt = iov.size();
+        uint64_t total = copyIov(iov, local);
+        if (total == UINT64_MAX) return false;
+        if constexpr (SendBufSize > 0) return writevQueued(local, cnt, total, more);
+        if (static_cast<uint64_t>(writevSome({local, cnt}, more)) != total) {
+            close("send error", true);
+            return false;
+        }
+        return true;
+    }
+
+    // 配置了 SendBufSize 时发不完的部分进入发送队列，由后续 poll 发送，队列满时断开连接
     bool write(const void* data_, uint32_t size, bool more = false) {
         const uint8_t* data = static_cast<const uint8_t*>(data_);
+        if constexpr (SendBufSize > 0) return writeQueued(data, size, more);
         do {
             int sent = writeSome(data, size, more);
             if (sent < 0) return false;
@@ -130,6 +990,7 @@ class SocketTcpConnection : public Conf::UserData {
     }
 
     bool writeNonblock(const void* data, uint32_t size, bool more = false) {
+        if constexpr (SendBufSize > 0) return writeQueued(static_cast<const uint8_t*>(data), size, more);
         if (writeSome(data, size, more) != static_cast<int>(size)) {
             close("send error", true);
             return false;
@@ -137,33 +998,362 @@ class SocketTcpConnection : public Conf::UserData {
         return true;
     }
 
+    // 发送队列中尚未发出的字节数，含 broadcast 引用的共享数据
+    uint32_t getSendQueued() { return send_tail_ - send_head_ + bcast_bytes_; }
+
+    // 不读 socket，把接收缓冲中之前 onTcpData 没有处理的数据再交给 handler，返回是否有这样的数据；
+    // 用于 handler 在数据回调之外才能继续处理的情况 (如 coro.h 中在其他事件里恢复的协程开始等待数据)，不能在本连接的 onTcpData 中调用
+    template <typename Handler>
+    bool redeliver(Handler& handler) {
+        if (!isConnected() || head_ == tail_) return false;
+        auto on_data = [&](const uint8_t* data, uint32_t size) { return onData(handler, data, size); };
+        consume(on_data);
+        return true;
+    }
+
+    // 零拷贝发送 (Conf::ZeroCopyThreshold > 0): 返回非 0 的 id 时，data 在 onSendComplete(conn, id) 回调之前不能修改；
+    // 小于阈值、内核不支持、未完成的零拷贝发送过多或发送队列非空时退回拷贝发送，返回 0 表示 data 可以立即复用；出错返回 -1。
+    // 连接断开后未完成的 id 不再回调
+    int64_t writeZeroCopy(const void* data_, uint32_t size) {
+        const uint8_t* data = static_cast<const uint8_t*>(data_);
+#ifndef _WIN32
+        if constexpr (ZeroCopyThreshold > 0) {
+            if (zc_enabled_ && size >= ZeroCopyThreshold && zc_cnt_ < ZeroCopyMaxPending && getSendQueued() == 0)
+                return writeZeroCopySome(data, size);
+        }
+#endif
+        return write(data, size) ? 0 : -1;
+    }
+
    protected:
     template <typename ServerConf>
     friend class SocketTcpServer;
+    friend class SocketTimers<Conf>;
+
+    enum : uint32_t { TimerConn = 1, TimerApp = 2 };
+
+    // 返回总字节数；段数超过 MaxIov 是调用方的错误，不关闭连接，记录错误并返回 UINT64_MAX
+    uint64_t copyIov(std::span<const struct iovec> iov, struct iovec* local) {
+        if (iov.size() > MaxIov) {
+            saveError("too many iovecs", false);
+            return UINT64_MAX;
+        }
+        uint64_t total = 0;
+        for (size_t i = 0; i < iov.size(); i++) {
+            local[i] = iov[i];
+            total += iov[i].iov_len;
+        }
+        return total;
+    }
+
+    static void advanceIov(struct iovec*& iov, size_t& cnt, size_t sent) {
+        while (cnt && sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + sent;
+            iov->iov_len -= sent;
+        }
+    }
+
+    // ret: 发出的字节数 (EAGAIN 时为 0)，-1 表示出错
+    void recordSend(int ret, uint64_t size) {
+        if (ret > 0) stats_.sent(ret);
+        if (ret >= 0 && static_cast<uint64_t>(ret) < size) stats_.partialWrite();
+    }
+
+    bool writeQueued(const uint8_t* data, uint32_t size, bool more) {
+        struct iovec iov = {const_cast<uint8_t*>(data), size};
+        return writevQueued(&iov, 1, size, more);
+    }
+
+    bool writevQueued(struct iovec* iov, size_t cnt, uint64_t total, bool more) {
+        if (!isConnected()) return false;
+        bool was_empty = getSendQueued() == 0;
+        if (was_empty) {
+            int sent = writevSome({iov, cnt}, more);
+            if (sent < 0) return false;
+            total -= sent;
+            if (total == 0) return true;
+            advanceIov(iov, cnt, sent);
+        }
+        if (total > SendBufSize - getSendQueued()) {
+            close("send buf full");
+            return false;
+        }
+        for (size_t i = 0; i < cnt; i++) {
+            const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+            uint32_t size = iov[i].iov_len;
+            uint32_t pos = send_tail_ & (SendBufSize - 1);
+            uint32_t n = std::min(size, SendBufSize - pos);
+            memcpy(sendbuf_ + pos, data, n);
+            memcpy(sendbuf_, data + n, size - n);
+            send_tail_ += size;
+        }
+        stats_.sendQueued(getSendQueued());
+        if (getSendQueued() >= conf_send_high_watermark<Conf>()) send_high_ = true;
+        if (was_empty && on_send_pending_) on_send_pending_(owner_, *this);
+        return true;
+    }
+
+    bool hasSendPending() { return getSendQueued() != 0 || send_high_ != send_high_reported_; }
+
+    // broadcast 的单个连接部分: 队列为空时直接 send，发不完或队列非空时引用 shared (第一次用到时才从池中拷贝)，
+    // 返回是否发出或排队成功
+    bool writeShared(const uint8_t* data, uint32_t size, SharedPayload*& shared, SharedPayloadPool& pool) {
+        if (!isConnected()) return false;
+        uint32_t off = 0;
+        bool was_empty = getSendQueued() == 0;
+        if (was_empty) {
+            int sent = writeSome(data, size);
+            if (sent < 0) return false;
+            if (static_cast<uint32_t>(sent) == size) return true;
+            off = sent;
+        }
+        bool full = bcast_cnt_ == BroadcastQueueLen || size - off > SendBufSize - getSendQueued();
+        if (!full && !shared) shared = pool.acquire(data, size);
+        if (full || !shared) {
+            // 已经发出一部分时不能跳过，否则对端收到的数据流不完整
+            if (conf_slow_consumer<Conf>() == SlowConsumerPolicy::Drop && off == 0) return false;
+            close(full ? "send buf full" : "broadcast buf exhausted");
+            return false;
+        }
+        BroadcastRef& ref = bcast_refs_[(bcast_head_ + bcast_cnt_++) % BroadcastSlots];
+        ref.payload = shared;
+        ref.off = off;
+        ref.pos = send_tail_;
+        shared->refs++;
+        bcast_bytes_ += size - off;
+        stats_.sendQueued(getSendQueued());
+        if (getSendQueued() >= conf_send_high_watermark<Conf>()) send_high_ = true;
+        if (was_empty && on_send_pending_) on_send_pending_(owner_, *this);
+        return true;
+    }
+
+    void releaseBroadcast() {
+        for (; bcast_cnt_; bcast_cnt_--) {
+            SharedPayload* p = bcast_refs_[bcast_head_].payload;
+            bcast_head_ = (bcast_head_ + 1) % BroadcastSlots;
+            if (--p->refs == 0) bcast_pool_->release(p);
+        }
+        bcast_head_ = bcast_bytes_ = 0;
+    }
+
+    // 按入队顺序填充待发送的数据: 每个 broadcast 引用之前先发出它入队之前写入环形队列的数据，返回 iovec 个数
+    uint32_t fillSendIov(struct iovec* iov) {
+        uint32_t cnt = 0;
+        uint32_t head = send_head_;
+        for (uint32_t i = 0;; i++) {
+            uint32_t end = i < bcast_cnt_ ? bcast_refs_[(bcast_head_ + i) % BroadcastSlots].pos : send_tail_;
+            if (end != head) {
+                uint32_t pos = head & (SendBufSize - 1);
+                uint32_t n = std::min(end - head, SendBufSize - pos);
+                iov[cnt++] = {sendbuf_ + pos, n};
+                if (n < end - head) iov[cnt++] = {sendbuf_, end - head - n};
+                head = end;
+            }
+            // 每个引用之后最多还有两段环形队列的数据
+            if (i == bcast_cnt_ || cnt + 3 > MaxIov) return cnt;
+            const BroadcastRef& ref = bcast_refs_[(bcast_head_ + i) % BroadcastSlots];
+            iov[cnt++] = {ref.payload->data.get() + ref.off, ref.payload->size - ref.off};
+        }
+    }
+
+    // 按 fillSendIov 的顺序消耗发出的字节，发完的共享数据解除引用
+    void consumeSent(uint32_t sent) {
+        while (true) {
+            uint32_t end = bcast_cnt_ ? bcast_refs_[bcast_head_].pos : send_tail_;
+            uint32_t n = std::min(sent, end - send_head_);
+            send_head_ += n;
+            sent -= n;
+            if (sent == 0) break;
+            BroadcastRef& ref = bcast_refs_[bcast_head_];
+            n = std::min(sent, ref.payload->size - ref.off);
+            ref.off += n;
+            bcast_bytes_ -= n;
+            sent -= n;
+            if (ref.off == ref.payload->size) {
+                if (--ref.payload->refs == 0) bcast_pool_->release(ref.payload);
+                bcast_head_ = (bcast_head_ + 1) % BroadcastSlots;
+                bcast_cnt_--;
+            }
+        }
+    }
 
+    bool hasZeroCopyPending() { return zc_cnt_ != 0; }
+
+#ifndef _WIN32
+    // 每次成功的 MSG_ZEROCOPY send 占用一个内核序号，一次 writeZeroCopy 可能对应多个序号，
+    // 记录最后一个序号，TCP 的完成通知按序到达
+    int64_t writeZeroCopySome(const uint8_t* data, uint32_t size) {
+        bool sent_any = false;
+        while (size) {
+            int ret = ::send(fd_, data, size, MSG_NOSIGNAL | MSG_ZEROCOPY);
+            recordSend(ret, size);
+            if (ret < 0) {
+                int err = get_last_error();
+                if (is_would_block(err)) {
+                    if constexpr (SendBufSize > 0) break;  // 剩余部分进入发送队列
+                    continue;
+                }
+                if (err == ENOBUFS) break;  // 超过 optmem 限制，剩余部分拷贝发送
+                close("send error", true);
+                return -1;
+            }
+            zc_next_seq_++;
+            sent_any = true;
+            data += ret;
+            size -= ret;
+        }
+        if (SendTimeoutNs) send_ts_ = wheel_->now();
+        if (size && !write(data, size)) return -1;
+        if (!sent_any) return 0;
+        ZeroCopyPending& p = zc_pending_[(zc_head_ + zc_cnt_++) % ZeroCopyMaxPending];
+        p.id = ++zc_last_id_;
+        p.last_seq = zc_next_seq_ - 1;
+        if (on_send_pending_) on_send_pending_(owner_, *this);
+        return p.id;
+    }
+
+    // 从错误队列读取完成通知，[ee_info, ee_data] 为已完成的序号区间
+    template <typename Handler>
+    void pollZeroCopy(Handler& handler) {
+        while (zc_cnt_ && isConnected()) {
+            alignas(struct cmsghdr) char control[128];
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (::recvmsg(fd_, &msg, MSG_ERRQUEUE) < 0) return;
+            for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+                    !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+                    continue;
+                struct sock_extended_err serr;
+                memcpy(&serr, CMSG_DATA(cm), sizeof(serr));
+                if (serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr.ee_errno != 0) continue;
+                if (static_cast<int32_t>(serr.ee_data + 1 - zc_done_seq_) > 0) zc_done_seq_ = serr.ee_data + 1;
+                // 内核实际做了拷贝 (如 loopback)，之后不再使用零拷贝以免白白锁定页面
+                if (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) zc_enabled_ = false;
+            }
+            while (zc_cnt_ && static_cast<int32_t>(zc_done_seq_ - zc_pending_[zc_head_].last_seq) > 0) {
+                uint32_t id = zc_pending_[zc_head_].id;
+                zc_head_ = (zc_head_ + 1) % ZeroCopyMaxPending;
+                zc_cnt_--;
+                if constexpr (requires { handler.onSendComplete(*this, id); }) handler.onSendComplete(*this, id);
+            }
+        }
+    }
+#endif
+
+    // 发送队列中的数据 (环形回绕最多两段，加上 broadcast 引用的共享数据) 一次 sendmsg 发出
+    template <typename Handler>
+    void pollSend(int64_t now, Handler& handler) {
+        if constexpr (SendBufSize > 0) {
+            if (send_high_ && !send_high_reported_) {
+                send_high_reported_ = true;
+                if constexpr (requires { handler.onSendHighWatermark(*this); }) handler.onSendHighWatermark(*this);
+            }
+            uint32_t queued = getSendQueued();
+            if (queued == 0 || !isConnected()) return;
+            struct iovec iov[MaxIov];
+            uint32_t cnt = fillSendIov(iov);
+#ifdef _WIN32
+            int ret = ::send(fd_, reinterpret_cast<const char*>(iov[0].iov_base), static_cast<int>(iov[0].iov_len), 0);
+#else
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = cnt;
+            int ret = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+#endif
+            if (ret < 0) {
+                if (is_would_block(get_last_error()))
+                    recordSend(0, queued);
+                else
+                    close("send error", true);
+                return;
+            }
+            recordSend(ret, queued);
+            consumeSent(ret);
+            if (getSendQueued() == 0) send_head_ = send_tail_ = 0;
+            if (SendTimeoutNs) send_ts_ = now;
+            if (send_high_reported_ && getSendQueued() <= conf_send_low_watermark<Conf>()) {
+                send_high_ = send_high_reported_ = false;
+                if constexpr (requires { handler.onSendLowWatermark(*this); }) handler.onSendLowWatermark(*this);
+            }
+            if constexpr (requires { handler.onSendDrained(*this); })
+                if (isConnected() && getSendQueued() == 0) handler.onSendDrained(*this);
+        }
+    }
+
+    // Drain: 边沿触发时需要一直读到 EAGAIN；返回是否收到数据或断开
+    template <bool Drain = false, typename Handler>
+    bool pollConn(int64_t now, Handler& handler) {
+#ifndef _WIN32
+        if (ZeroCopyThreshold > 0 && zc_cnt_) pollZeroCopy(handler);
+#endif
+        if (SendBufSize > 0 && hasSendPending()) pollSend(now, handler);
+        auto on_data = [&](const uint8_t* data, uint32_t size) { return onData(handler, data, size); };
+        bool got_data = read(on_data);
+        if constexpr (Drain) {
+            if (got_data)
+                while (isConnected() && read(on_data));
+        }
+        if (RecvTimeoutNs && got_data) expire_ts_ = now + RecvTimeoutNs;
+        return got_data || !isConnected();
+    }
+
+    // 收发时只更新 expire_ts_/send_ts_，定时器仍挂在旧的到期时间上；
+    // 到期时若期间有过活动则按新的时间重新挂上，否则回调超时
     template <typename Handler>
-    void pollConn(int64_t now, Handler& handler) {
-        if (Conf::SendTimeoutSec && now >= send_ts_ + Conf::SendTimeoutSec) {
-            handler.onSendTimeout(*this);
-            send_ts_ = now;
-        }
-        bool got_data = read(
-            [&](const uint8_t* data, uint32_t size) { return handler.onTcpData(*this, data, size); });
-        if (Conf::RecvTimeoutSec) {
-            if (!got_data && now >= expire_ts_) {
+    void onTimer(TimerNode& node, int64_t now, Handler& handler) {
+        if (&node == &recv_timer_) {
+            if (now >= expire_ts_) {
                 handler.onRecvTimeout(*this);
-                got_data = true;
+                expire_ts_ = now + RecvTimeoutNs;
             }
-            if (got_data) expire_ts_ = now + Conf::RecvTimeoutSec;
+            if (isConnected()) wheel_->arm(recv_timer_, expire_ts_);
+        } else {
+            if (now >= send_ts_ + SendTimeoutNs) {
+                handler.onSendTimeout(*this);
+                send_ts_ = now;
+            }
+            if (isConnected()) wheel_->arm(send_timer_, send_ts_ + SendTimeoutNs);
         }
     }
 
+    // handler 定义了 onTcpData(conn, data, size, const RxTimestamp&) 时优先调用，
+    // 时间戳为最近一次 recv 读到的最后一个包的时间，io_uring 后端下总是 0
+    template <typename Handler>
+    uint32_t onData(Handler& handler, const uint8_t* data, uint32_t size) {
+        int64_t begin = stats_.handlerBegin();
+        uint32_t remaining;
+        if constexpr (requires { handler.onTcpData(*this, data, size, rx_ts_); })
+            remaining = handler.onTcpData(*this, data, size, rx_ts_);
+        else
+            remaining = handler.onTcpData(*this, data, size);
+        stats_.handlerEnd(begin);
+        return remaining;
+    }
+
     template <typename Handler>
     bool read(Handler handler) {
-        // 使用 recv 替代 read，支持跨平台
-        int ret = ::recv(fd_, reinterpret_cast<char*>(recvbuf_ + tail_), Conf::RecvBufSize - tail_, 0);
+        int ret;
+#ifndef _WIN32
+        if constexpr (Timestamping != TimestampMode::None)
+            ret = recvTimestamped(recvBase() + tail_, recvSpace());
+        else
+#endif
+            // 使用 recv 替代 read，支持跨平台
+            ret = ::recv(fd_, reinterpret_cast<char*>(recvBase() + tail_), recvSpace(), 0);
         if (ret <= 0) {
-            if (ret < 0 && is_would_block(get_last_error())) return false;
+            if (ret < 0 && is_would_block(get_last_error())) {
+                stats_.recvEagain();
+                return false;
+            }
             if (ret < 0)
                 close("read error", true);
             else
@@ -171,40 +1361,201 @@ class SocketTcpConnection : public Conf::UserData {
             return false;
         }
         tail_ += ret;
+        stats_.received(ret);
+        stats_.recvBuffered(tail_ - head_);
+        consume(handler);
+        return true;
+    }
+
+#ifndef _WIN32
+    int recvTimestamped(uint8_t* buf, uint32_t size) {
+        struct iovec iov = {buf, size};
+        alignas(struct cmsghdr) char control[RxTimestampControlSize];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        int ret = ::recvmsg(fd_, &msg, 0);
+        if (ret > 0) parse_rx_timestamp(msg, rx_ts_);
+        return ret;
+    }
+#endif
 
-        uint32_t remaining = handler(recvbuf_ + head_, tail_ - head_);
+    // 处理 recvbuf_ 中 [head_, tail_) 的数据，保留未处理的半包
+    template <typename Handler>
+    void consume(Handler& handler) {
+        uint32_t remaining = handler(recvBase() + head_, tail_ - head_);
+        // handler 中关闭连接时 close 已经归还了 spill 缓冲，不能再按旧的位置搬移数据
+        if (!isConnected()) return;
         if (remaining == 0) {
             head_ = tail_ = 0;
+            if (spill_) releaseSpill();
+        } else if constexpr (Mirrored) {
+            // head_ 越过末尾时整体减去 RecvBufSize，数据本身不需要移动
+            head_ = tail_ - remaining;
+            if (head_ >= Conf::RecvBufSize) {
+                head_ -= Conf::RecvBufSize;
+                tail_ -= Conf::RecvBufSize;
+            }
+            if (remaining == Conf::RecvBufSize) close("recv buf full");
         } else {
             head_ = tail_ - remaining;
-            if (head_ >= Conf::RecvBufSize / 2) {
-                memmove(recvbuf_, recvbuf_ + head_, remaining);  // C++ 中 memmove 比 memcpy 安全
+            if constexpr (Spill) {
+                // 大消息处理完，剩余的半包放回内联缓冲并归还大缓冲
+                if (spill_ && remaining < Conf::RecvBufSize) {
+                    memcpy(recvbuf_, spill_ + head_, remaining);
+                    head_ = 0;
+                    tail_ = remaining;
+                    releaseSpill();
+                    return;
+                }
+            }
+            uint8_t* base = recvBase();
+            uint32_t cap = recvCap();
+            // 半包不多时搬到开头；缓冲写满时只要开头有空间也要搬，否则不超过缓冲大小的帧也可能收不完整
+            if (head_ >= cap / 2 || (tail_ == cap && head_ > 0)) {
+                memmove(base, base + head_, remaining);  // C++ 中 memmove 比 memcpy 安全
+                stats_.compaction();
                 head_ = 0;
                 tail_ = remaining;
-            } else if (tail_ == Conf::RecvBufSize) {
-                close("recv buf full");
+            } else if (tail_ == cap) {
+                if (!spillPartial(recvbuf_ + head_, remaining)) close("recv buf full");
             }
         }
-        return true;
     }
 
-    bool open(int64_t now, socket_t fd) {
+    // 内联缓冲装不下的半包搬到借来的大缓冲，非 Spill 模式或池已耗尽时返回 false
+    bool spillPartial(const uint8_t* data, uint32_t size) {
+        if constexpr (Spill) {
+            if (!spill_ && size < SpillBufSize && spill_pool_ && (spill_ = spill_pool_->acquire())) {
+                memcpy(spill_, data, size);
+                head_ = 0;
+                tail_ = size;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void releaseSpill() {
+        spill_pool_->release(spill_);
+        spill_ = nullptr;
+    }
+
+    // 数据已由内核写入外部 buffer (io_uring)：没有半包时直接在外部 buffer 上回调，只拷贝剩余部分
+    template <typename Handler>
+    void readFrom(const uint8_t* data, uint32_t size, Handler handler) {
+        if (head_ == tail_) {
+            uint32_t remaining = handler(data, size);
+            if (!isConnected()) return;
+            if (remaining >= Conf::RecvBufSize) {
+                if (!spillPartial(data + size - remaining, remaining)) close("recv buf full");
+                return;
+            }
+            memcpy(recvBase(), data + size - remaining, remaining);
+            head_ = 0;
+            tail_ = remaining;
+            return;
+        }
+        while (size && isConnected()) {
+            uint32_t n = std::min(size, recvSpace());
+            memcpy(recvBase() + tail_, data, n);
+            tail_ += n;
+            data += n;
+            size -= n;
+            consume(handler);
+        }
+    }
+
+    template <typename Handler>
+    void pollData(int64_t now, const uint8_t* data, uint32_t size, Handler& handler) {
+        stats_.received(size);
+        stats_.recvBuffered(tail_ - head_ + size);
+        readFrom(data, size, [&](const uint8_t* data, uint32_t size) { return onData(handler, data, size); });
+        if (RecvTimeoutNs) expire_ts_ = now + RecvTimeoutNs;
+    }
+
+    uint8_t* recvBase() {
+#ifndef _WIN32
+        if constexpr (Mirrored) return mirror_.data();
+#endif
+        if constexpr (Spill)
+            if (spill_) return spill_;
+        return recvbuf_;
+    }
+
+    uint32_t recvCap() {
+        if constexpr (Spill)
+            if (spill_) return SpillBufSize;
+        return Conf::RecvBufSize;
+    }
+
+    // 从 tail_ 开始可以连续写入的字节数
+    uint32_t recvSpace() {
+        if constexpr (Mirrored)
+            return Conf::RecvBufSize - (tail_ - head_);
+        else
+            return recvCap() - tail_;
+    }
+
+    // accepted: fd 由 accept4(SOCK_NONBLOCK) 或 io_uring accept 得到，已经是非阻塞的，
+    // 并且从监听 socket 继承了 TCP_NODELAY (Linux)，省去 fcntl 和 setsockopt
+    bool open(int64_t now, socket_t fd, bool accepted = false) {
         fd_ = fd;
         head_ = tail_ = 0;
+        send_head_ = send_tail_ = 0;
+        send_high_ = send_high_reported_ = false;
+        epoll_out_ = false;
+        zc_cnt_ = zc_head_ = zc_next_seq_ = zc_done_seq_ = 0;
         send_ts_ = now;
-        expire_ts_ = now + Conf::RecvTimeoutSec;
+        expire_ts_ = now + RecvTimeoutNs;
+        session_++;
+        if (RecvTimeoutNs) wheel_->arm(recv_timer_, expire_ts_);
+        if (SendTimeoutNs) wheel_->arm(send_timer_, send_ts_ + SendTimeoutNs);
 
-        if (!set_nonblocking(fd_)) {
+        if (!accepted && !set_nonblocking(fd_)) {
             close("fcntl/ioctlsocket O_NONBLOCK error", true);
             return false;
         }
 
+#ifndef _WIN32
+        // 第一次打开时建立映射，之后重连复用
+        if constexpr (Mirrored) {
+            if (!mirror_.init(Conf::RecvBufSize)) {
+                close("mirror recv buf error", true);
+                return false;
+            }
+        }
+#endif
+
         int yes = 1;
-        if (setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<sockopt_val_t>(&yes), sizeof(yes)) < 0) {
+        if (!accepted && !Unix &&
+            setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<sockopt_val_t>(&yes), sizeof(yes)) < 0) {
             close("setsockopt TCP_NODELAY error", true);
             return false;
         }
 
+#ifndef _WIN32
+        if constexpr (Timestamping != TimestampMode::None) {
+            if (!set_rx_timestamping(fd_, Timestamping)) {
+                close("setsockopt SO_TIMESTAMPING error", true);
+                return false;
+            }
+        }
+
+        if constexpr (BusyPollUs > 0 || PreferBusyPoll) {
+            if (!set_busy_poll(fd_, BusyPollUs, PreferBusyPoll)) {
+                close("setsockopt SO_BUSY_POLL error", true);
+                return false;
+            }
+        }
+
+        // 内核不支持 SO_ZEROCOPY 时 writeZeroCopy 退回拷贝发送
+        if constexpr (ZeroCopyThreshold > 0) zc_enabled_ = setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &yes, sizeof(yes)) == 0;
+#endif
+
         return true;
     }
 
@@ -224,59 +1575,245 @@ class SocketTcpConnection : public Conf::UserData {
     socket_t fd_ = INVALID_SOCKET_FD;
     int64_t send_ts_ = 0;
     int64_t expire_ts_ = 0;
+    // 所属 server/client 的时间轮，收发超时各占一个节点
+    TimerWheel* wheel_ = nullptr;
+    TimerNode recv_timer_{nullptr, nullptr, 0, TimerConn, this};
+    TimerNode send_timer_{nullptr, nullptr, 0, TimerConn, this};
+    // 每次 open 加一，addTimer 的定时器据此丢弃属于已关闭连接的回调
+    uint64_t session_ = 0;
     uint32_t head_ = 0;
     uint32_t tail_ = 0;
-    uint8_t recvbuf_[Conf::RecvBufSize];
+    RxTimestamp rx_ts_;
+    uint8_t recvbuf_[Mirrored ? 1 : Conf::RecvBufSize];
+#ifndef _WIN32
+    MirrorBuffer mirror_;
+#endif
+    // Spill 模式下当前借用的大缓冲，为空时使用 recvbuf_
+    SpillPool* spill_pool_ = nullptr;
+    uint8_t* spill_ = nullptr;
     char last_error_[64] = "";
+    [[no_unique_address]] SocketStatsRecorder<Stats> stats_;
+
+    // 发送队列由空变非空、连接关闭时通知所属 server (client 中为空)；不直接持有 SocketTcpServer<Conf>*，
+    // 否则 client 的 Conf 也会实例化 server 模板
+    void* owner_ = nullptr;
+    void (*on_send_pending_)(void* owner, SocketTcpConnection& conn) = nullptr;
+    void (*on_closed_)(void* owner, SocketTcpConnection& conn) = nullptr;
+
+    // 发送队列: [send_head_, send_tail_) 为未发出的数据，取模映射到 sendbuf_
+    uint32_t send_head_ = 0;
+    uint32_t send_tail_ = 0;
+    bool send_high_ = false;
+    bool send_high_reported_ = false;
+    bool send_listed_ = false;   // 已在 io_uring 后端的待发送列表中
+    bool close_listed_ = false;  // 已在 epoll/io_uring 后端的已关闭列表中
+    bool epoll_out_ = false;     // 已在 epoll 中注册 EPOLLOUT
+    uint8_t sendbuf_[SendBufSize ? SendBufSize : 1];
+
+    // broadcast 引用的共享数据: 环形队列 [bcast_head_, bcast_head_ + bcast_cnt_)，
+    // pos 为入队时的 send_tail_，环形队列中在它之前的数据先发
+    struct BroadcastRef {
+        SharedPayload* payload;
+        uint32_t off;
+        uint32_t pos;
+    };
+    SharedPayloadPool* bcast_pool_ = nullptr;
+    uint32_t bcast_head_ = 0;
+    uint32_t bcast_cnt_ = 0;
+    uint32_t bcast_bytes_ = 0;
+    BroadcastRef bcast_refs_[BroadcastSlots];
+
+    // 未完成的零拷贝发送: 环形队列 [zc_head_, zc_head_ + zc_cnt_)
+    struct ZeroCopyPending {
+        uint32_t id;
+        uint32_t last_seq;
+    };
+    bool zc_enabled_ = false;
+    uint32_t zc_cnt_ = 0;
+    uint32_t zc_head_ = 0;
+    uint32_t zc_next_seq_ = 0;
+    uint32_t zc_done_seq_ = 0;
+    uint32_t zc_last_id_ = 0;
+    ZeroCopyPending zc_pending_[ZeroCopyThreshold ? ZeroCopyMaxPending : 1];
+};
+
+// server/client 共用的时间轮: 连接的收发超时以及 addTimer 添加的应用定时器
+template <typename Conf>
+class SocketTimers {
+    using Conn = SocketTcpConnection<Conf>;
+    static constexpr uint32_t MaxTimers = conf_max_timers<Conf>();
+
+   public:
+    using Callback = std::function<void(Conn&)>;
+
+    SocketTimers() : apps_(std::make_unique<AppTimer[]>(MaxTimers)) {
+        for (uint32_t i = 0; i < MaxTimers; i++) {
+            apps_[i].node.kind = Conn::TimerApp;
+            apps_[i].node.ptr = &apps_[i];
+            free_[i] = MaxTimers - 1 - i;
+        }
+        free_cnt_ = MaxTimers;
+    }
+
+    TimerWheel& wheel() { return wheel_; }
+
+    // id 高 32 位为槽位的 generation，取消已触发或已复用的 id 不会误伤新的定时器
+    uint64_t add(Conn& conn, uint32_t ms, Callback cb) {
+        if (!free_cnt_) return 0;
+        uint32_t idx = free_[--free_cnt_];
+        AppTimer& t = apps_[idx];
+        t.conn = &conn;
+        t.session = conn.session_;
+        t.cb = std::move(cb);
+        wheel_.arm(t.node, wheel_.now() + ms * 1000000LL);
+        return static_cast<uint64_t>(t.gen) << 32 | idx;
+    }
+
+    bool cancel(uint64_t id) {
+        uint32_t idx = static_cast<uint32_t>(id);
+        if (idx >= MaxTimers) return false;
+        AppTimer& t = apps_[idx];
+        if (t.gen != id >> 32 || !t.node.isArmed()) return false;
+        wheel_.cancel(t.node);
+        release(t);
+        return true;
+    }
+
+    // on_closed(conn): 定时器回调中被关闭的连接；返回是否有定时器到期
+    template <typename Handler, typename OnClosed>
+    bool poll(int64_t now, Handler& handler, OnClosed on_closed) {
+        bool fired = false;
+        wheel_.advance(now, [&](TimerNode& node) {
+            fired = true;
+            Conn* conn;
+            if (node.kind == Conn::TimerApp) {
+                AppTimer& t = *static_cast<AppTimer*>(node.ptr);
+                conn = t.conn;
+                bool alive = conn->isConnected() && conn->session_ == t.session;
+                Callback cb = std::move(t.cb);
+                release(t);  // 先释放槽位，回调中可以继续 addTimer
+                if (!alive) return;
+                cb(*conn);
+            } else {
+                conn = static_cast<Conn*>(node.ptr);
+                conn->onTimer(node, now, handler);
+            }
+            if (!conn->isConnected()) on_closed(*conn);
+        });
+        return fired;
+    }
+
+   private:
+    struct AppTimer {
+        TimerNode node;
+        Conn* conn = nullptr;
+        uint64_t session = 0;
+        uint32_t gen = 1;
+        Callback cb;
+    };
+
+    void release(AppTimer& t) {
+        t.gen++;
+        t.cb = nullptr;
+        free_[free_cnt_++] = &t - apps_.get();
+    }
+
+    TimerWheel wheel_;
+    std::unique_ptr<AppTimer[]> apps_;
+    uint32_t free_[MaxTimers];
+    uint32_t free_cnt_ = 0;
 };
 
 template <typename Conf>
 class SocketTcpClient : public SocketTcpConnection<Conf> {
+    static constexpr bool Unix = conf_family<Conf>() == AddressFamily::Unix;
+
    public:
     using Conn = SocketTcpConnection<Conf>;
 
+    // 基类析构时 spill_buf_pool_ 已经析构，先在这里归还大缓冲
+    ~SocketTcpClient() { this->close("destruct"); }
+
+    // Conf::Family 为 AddressFamily::Unix 时 server_ip 为 socket 路径，server_port 和 local_port 被忽略
     bool init(const char* interface_ip, const char* server_ip, uint16_t server_port, uint16_t local_port = 0) {
         ensure_network_init();
 
-        server_addr_.sin_family = AF_INET;
-        inet_pton(AF_INET, server_ip, &(server_addr_.sin_addr));
-        server_addr_.sin_port = htons(server_port);
-        memset(&(server_addr_.sin_zero), 0, 8);  // bzero 非标准，改用 memset
+        memset(&server_addr_, 0, sizeof(server_addr_));  // bzero 非标准，改用 memset
+        if constexpr (Unix) {
+#ifndef _WIN32
+            server_addr_len_ = make_unix_addr(server_ip, reinterpret_cast<struct sockaddr_un&>(server_addr_));
+#endif
+            local_port = 0;
+        } else {
+            auto& addr = reinterpret_cast<struct sockaddr_in&>(server_addr_);
+            addr.sin_family = AF_INET;
+            inet_pton(AF_INET, server_ip, &(addr.sin_addr));
+            addr.sin_port = htons(server_port);
+            server_addr_len_ = sizeof(addr);
+        }
         local_port_be_ = htons(local_port);
+        Conn::spill_pool_ = &spill_buf_pool_;
+        Conn::wheel_ = &timers_.wheel();
         return true;
     }
 
     void allowReconnect() { next_conn_ts_ = 0; }
 
+    // ms 毫秒后在 poll 中回调 cb(conn)，返回定时器 id，定时器数量已满时返回 0；连接在此之前断开则不回调
+    uint64_t addTimer(Conn& conn, uint32_t ms, std::function<void(Conn&)> cb) {
+        return timers_.add(conn, ms, std::move(cb));
+    }
+
+    bool cancelTimer(uint64_t id) { return timers_.cancel(id); }
+
+    // 返回本次是否做了事: 定时器到期、连接建立/失败/断开、收到数据，供空闲策略使用
     template <typename Handler>
-    void poll(Handler& handler) {
-        int64_t now = time(0);
+    bool poll(Handler& handler) {
+        int64_t now = clock_now_ns<conf_clock<Conf>()>();
+        bool did_work = timers_.poll(now, handler, [](Conn&) {});  // 定时器中断开的连接在下一次 poll 报告
         if (!this->isConnected()) {
             if (report_disconnect_) {
                 handler.onTcpDisconnect(*this);
                 report_disconnect_ = false;
+                did_work = true;
             }
             int ret = connect(now);
             if (ret <= 0) {
                 if (ret < 0) handler.onTcpConnectFailed();
-                return;
+                return did_work || ret < 0;
             }
             report_disconnect_ = true;
             handler.onTcpConnected(*this);
+            did_work = true;
+        }
+        return this->pollConn(now, handler) || did_work;
+    }
+
+    // 阻塞最多 timeout_ms 直到连接可读 (有待发送数据时可写)、正在进行的 connect 完成，返回是否就绪；
+    // 不推进定时器，未连接且不在重连时只是 sleep
+    bool wait(int timeout_ms) {
+        if (this->isConnected()) {
+            if (this->send_high_ != this->send_high_reported_) return true;  // 高水位回调还没报告
+            short events = POLLIN;
+            if (this->hasSendPending()) events |= POLLOUT;
+            return wait_fd(this->fd_, events, timeout_ms);
         }
-        this->pollConn(now, handler);
+        if (report_disconnect_) return true;
+        if (conn_fd_ != INVALID_SOCKET_FD) return wait_fd(conn_fd_, POLLOUT, timeout_ms);
+        poll_fds(nullptr, 0, timeout_ms);
+        return false;
     }
 
    private:
     int connect(int64_t now) {
         if (conn_fd_ == INVALID_SOCKET_FD) {
             if (now < next_conn_ts_) return 0;
-            if (Conf::ConnRetrySec)
-                next_conn_ts_ = now + Conf::ConnRetrySec;
+            if (conf_conn_retry_ns<Conf>())
+                next_conn_ts_ = now + conf_conn_retry_ns<Conf>();
             else
                 next_conn_ts_ = std::numeric_limits<int64_t>::max();
 
-            socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+            socket_t fd = socket(Unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
             if (fd == INVALID_SOCKET_FD) {
                 Conn::saveError("socket error", true);
                 return -1;
@@ -300,13 +1837,13 @@ class SocketTcpClient : public SocketTcpConnection<Conf> {
             }
             conn_fd_ = fd;
 
-            if (Conf::ConnTimeoutSec)
-                conn_expire_ts_ = now + Conf::ConnTimeoutSec;
+            if (conf_conn_timeout_ns<Conf>())
+                conn_expire_ts_ = now + conf_conn_timeout_ns<Conf>();
             else
                 conn_expire_ts_ = std::numeric_limits<int64_t>::max();
         }
 
-        int ret = ::connect(conn_fd_, (struct sockaddr*)&server_addr_, sizeof(server_addr_));
+        int ret = ::connect(conn_fd_, (struct sockaddr*)&server_addr_, server_addr_len_);
         int err = get_last_error();
 
         if (ret == 0 || is_isconn(err)) {
@@ -336,20 +1873,39 @@ class SocketTcpClient : public SocketTcpConnection<Conf> {
     socket_t conn_fd_ = INVALID_SOCKET_FD;
     int64_t next_conn_ts_ = 0;
     int64_t conn_expire_ts_ = 0;
-    struct sockaddr_in server_addr_;
+    // sockaddr_in 或 sockaddr_un
+    struct sockaddr_storage server_addr_;
+    socklen_t server_addr_len_;
     uint16_t local_port_be_;
+    SocketTimers<Conf> timers_;
+    // client 只有一个连接，独占一块大缓冲
+    SpillPool spill_buf_pool_{conf_spill_buf_size<Conf>(), conf_recv_buf_mode<Conf>() == RecvBufMode::Spill ? 1u : 0u};
 };
 
 template <typename Conf>
 class SocketTcpServer {
+    static constexpr PollBackend Backend = conf_backend<Conf>();
+    static constexpr bool UseEpoll = Backend == PollBackend::EpollLevel || Backend == PollBackend::EpollEdge;
+    static constexpr bool UseUring = Backend == PollBackend::IoUring;
+    static constexpr uint32_t MaxSteerCpus = 256;
+    static constexpr bool Unix = conf_family<Conf>() == AddressFamily::Unix;
+    static constexpr uint32_t ReplyQueueLen = conf_reply_queue_len<Conf>();
+#ifdef _WIN32
+    static_assert(Backend == PollBackend::Scan, "epoll/io_uring backend is only available on Linux");
+#endif
+
+    friend class SocketTcpConnection<Conf>;
+
    public:
     using Conn = SocketTcpConnection<Conf>;
 
-    bool init(const char* interface_ip, const char* server_ip, uint16_t server_port) {
+    // reuse_port: 多个 server 绑定同一端口，由内核在它们之间分配新连接 (仅 Linux，不支持 unix socket)
+    // Conf::Family 为 AddressFamily::Unix 时 server_ip 为 socket 路径，已存在的同名文件会先被删除，server_port 被忽略
+    bool init(const char* interface_ip, const char* server_ip, uint16_t server_port, bool reuse_port = false) {
         ensure_network_init();
 
         for (uint32_t i = 0; i < Conf::MaxConns; i++) conns_[i] = conns_data_ + i;
-        listenfd_ = socket(AF_INET, SOCK_STREAM, 0);
+        listenfd_ = socket(Unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
         if (listenfd_ == INVALID_SOCKET_FD) {
             saveError("socket error");
             return false;
@@ -365,22 +1921,77 @@ class SocketTcpServer {
             close("setsockopt SO_REUSEADDR error");
             return false;
         }
+        if (reuse_port) {
+            // 多个进程同时 bind 一个 unix socket 路径时后者会删掉前者的 socket 文件
+            if (Unix) {
+                close("SO_REUSEPORT not supported on unix socket");
+                return false;
+            }
+#ifdef _WIN32
+            close("SO_REUSEPORT not supported");
+            return false;
+#else
+            if (setsockopt(listenfd_, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes)) < 0) {
+                close("setsockopt SO_REUSEPORT error");
+                return false;
+            }
+#endif
+        }
 
-        struct sockaddr_in local_addr;
-        local_addr.sin_family = AF_INET;
-        inet_pton(AF_INET, server_ip, &(local_addr.sin_addr));
-        local_addr.sin_port = htons(server_port);
-        memset(&(local_addr.sin_zero), 0, 8);
+        struct sockaddr_storage local_addr;
+        socklen_t local_addr_len;
+        memset(&local_addr, 0, sizeof(local_addr));
+        if constexpr (Unix) {
+#ifndef _WIN32
+            auto& addr = reinterpret_cast<struct sockaddr_un&>(local_addr);
+            local_addr_len = make_unix_addr(server_ip, addr);
+            // 上次进程退出时留下的 socket 文件会让 bind 失败
+            if (addr.sun_path[0]) unlink(addr.sun_path);
+#endif
+        } else {
+            auto& addr = reinterpret_cast<struct sockaddr_in&>(local_addr);
+            addr.sin_family = AF_INET;
+            inet_pton(AF_INET, server_ip, &(addr.sin_addr));
+            addr.sin_port = htons(server_port);
+            local_addr_len = sizeof(addr);
+        }
 
-        if (::bind(listenfd_, (struct sockaddr*)&local_addr, sizeof(local_addr)) < 0) {
+        if (::bind(listenfd_, (struct sockaddr*)&local_addr, local_addr_len) < 0) {
             close("bind error");
             return false;
         }
-        if (listen(listenfd_, 5) < 0) {
+#ifndef _WIN32
+        // accept 得到的连接继承 TCP_NODELAY，open 中不用再逐个设置
+        if (!Unix && setsockopt(listenfd_, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) < 0) {
+            close("setsockopt TCP_NODELAY error");
+            return false;
+        }
+#endif
+        if (listen(listenfd_, conf_listen_backlog<Conf>()) < 0) {
             close("listen error");
             return false;
         }
 
+#ifndef _WIN32
+        if constexpr (UseEpoll) {
+            if ((epfd_ = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+                close("epoll_create1 error");
+                return false;
+            }
+            // 监听 fd 固定使用水平触发，未 accept 完的连接下次仍会被报告
+            struct epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.ptr = nullptr;
+            if (epoll_ctl(epfd_, EPOLL_CTL_ADD, listenfd_, &ev) < 0) {
+                close("epoll_ctl listenfd error");
+                return false;
+            }
+        }
+        if constexpr (UseUring) {
+            if (!initUring()) ring_.close();  // 内核不支持时退回 Scan 轮询
+        }
+#endif
+
         return true;
     }
 
@@ -390,6 +2001,14 @@ class SocketTcpServer {
             close_socket(listenfd_);
             listenfd_ = INVALID_SOCKET_FD;
         }
+#ifndef _WIN32
+        if (epfd_ >= 0) {
+            ::close(epfd_);
+            epfd_ = -1;
+        }
+        // 关闭 ring 会取消所有请求并释放注册文件表，已有连接退回 Scan 轮询
+        ring_.close();
+#endif
     }
 
     const char* getLastError() { return last_error_; }
@@ -400,40 +2019,431 @@ class SocketTcpServer {
 
     uint32_t getConnCnt() { return conns_cnt_; }
 
+    // 所有连接的累计计数 (含已断开的)，Conf::Stats 为 true 时有效；可以在其他线程调用，开销与 MaxConns 成正比
+    SocketStats getStats() const {
+        SocketStats stats = retired_stats_.snapshot();
+        if constexpr (conf_stats<Conf>()) {
+            for (uint32_t i = 0; i < Conf::MaxConns; i++) stats += conns_data_[i].getStats();
+        }
+        return stats;
+    }
+
+#ifndef _WIN32
+    // 给 SO_REUSEPORT 组挂一个 CBPF 程序: 在 cpus[i] 上收到的 SYN 交给组内第 i 个 socket (按 bind 顺序)，
+    // 其余 CPU 取模；组内任意一个 server 调用一次即可
+    bool steerByCpu(const int* cpus, uint32_t group_size) {
+        struct sock_filter code[3 + 2 * MaxSteerCpus];
+        uint32_t n = 0;
+        code[n++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU));
+        for (uint32_t i = 0; cpus && i < std::min(group_size, MaxSteerCpus); i++) {
+            code[n++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpus[i]), 0, 1);
+            code[n++] = BPF_STMT(BPF_RET | BPF_K, i);
+        }
+        code[n++] = BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, group_size);
+        code[n++] = BPF_STMT(BPF_RET | BPF_A, 0);
+        struct sock_fprog prog;
+        prog.len = n;
+        prog.filter = code;
+        if (setsockopt(listenfd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+            saveError("setsockopt SO_ATTACH_REUSEPORT_CBPF error");
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    template <typename Handler>
+    void foreachConn(Handler handler) {
+        for (uint32_t i = 0; i < conns_cnt_; i++) {
+            Conn& conn = *conns_[i];
+            handler(conn);
+        }
+    }
+
+    // 同一份数据发给所有连接 (需要 SendBufSize > 0)，返回发出或排队成功的连接数。发送队列为空的连接直接 send，
+    // 有连接发不完时数据只拷贝一次，由各连接的发送队列引用计数共享，之后与队列中的其他数据一起 sendmsg 发出。
+    // 队列放不下 (超过 SendBufSize 字节或 BroadcastQueueLen 个引用) 的慢连接按 Conf::SlowConsumer 断开或跳过
+    uint32_t broadcast(const void* data, uint32_t size) {
+        static_assert(conf_send_buf_size<Conf>() > 0 && conf_broadcast_queue_len<Conf>() > 0,
+                      "broadcast requires SendBufSize and BroadcastQueueLen");
+        SharedPayload* shared = nullptr;
+        uint32_t cnt = 0;
+        for (uint32_t i = 0; i < conns_cnt_; i++)
+            cnt += conns_[i]->writeShared(static_cast<const uint8_t*>(data), size, shared, bcast_pool_);
+        if (shared && shared->refs == 0) bcast_pool_.release(shared);
+        return cnt;
+    }
+
+    // ms 毫秒后在 poll 中回调 cb(conn)，返回定时器 id，定时器数量已满时返回 0；连接在此之前断开则不回调
+    uint64_t addTimer(Conn& conn, uint32_t ms, std::function<void(Conn&)> cb) {
+        return timers_.add(conn, ms, std::move(cb));
+    }
+
+    bool cancelTimer(uint64_t id) { return timers_.cancel(id); }
+
+    // 交给其他线程的连接引用，见 msg_queue.h
+    ConnHandle getHandle(Conn& conn) {
+        return {static_cast<uint32_t>(&conn - conns_data_), static_cast<uint32_t>(conn.session_)};
+    }
+
+    // handle 对应的连接仍然打开且没有被新连接复用时返回它，否则返回 nullptr；只能在 poll 线程调用
+    Conn* getConn(ConnHandle h) {
+        if (h.idx >= Conf::MaxConns) return nullptr;
+        Conn& conn = conns_data_[h.idx];
+        return conn.isConnected() && static_cast<uint32_t>(conn.session_) == h.session ? &conn : nullptr;
+    }
+
+    // 可以在任意线程调用 (需要 Conf::ReplyQueueLen)，data 被拷贝进回复队列，之后由 poll 线程 write 到 handle 对应的连接；
+    // 连接已断开时丢弃。队列满或 size 超过 ReplyMaxSize 时返回 false。
+    // poll 线程阻塞在 wait 中时不会被唤醒，回复最多推迟空闲策略的 timeout_ms
+    bool reply(ConnHandle h, const void* data, uint32_t size) {
+        static_assert(ReplyQueueLen > 0, "reply requires ReplyQueueLen");
+        return replies_.push(h, data, size);
+    }
+
+    // 返回本次是否做了事: 定时器到期、新连接、收到数据、断开、处理了 epoll 事件或 CQE，供空闲策略使用
+    template <typename Handler>
+    bool poll(Handler& handler) {
+        int64_t now = clock_now_ns<conf_clock<Conf>()>();
+        bool did_work = timers_.poll(now, handler, [&](Conn& conn) { removeConn(conn, handler); });
+        if constexpr (ReplyQueueLen > 0) did_work |= pollReplies();
+#ifndef _WIN32
+        if constexpr (UseEpoll) return pollEpoll(now, handler) || did_work;
+        if constexpr (UseUring) {
+            if (ring_.isOpen()) return pollUring(now, handler) || did_work;
+        }
+#endif
+        did_work |= accept(now, handler);
+        for (uint32_t i = 0; i < conns_cnt_;) {
+            Conn& conn = *conns_[i];
+            did_work |= conn.pollConn(now, handler);
+            if (conn.isConnected())
+                i++;
+            else {
+                std::swap(conns_[i], conns_[--conns_cnt_]);
+                handler.onTcpDisconnect(conn);
+            }
+        }
+        return did_work;
+    }
+
+    // 阻塞最多 timeout_ms 直到有新连接、连接可读或待发送的连接可写，返回是否就绪，之后调用 poll 处理；
+    // 不推进定时器，定时器最多推迟 timeout_ms。epoll/io_uring 等待 epfd/ring fd，Scan 对所有连接调用 poll(2)
+    bool wait(int timeout_ms) {
+        if constexpr (ReplyQueueLen > 0) {
+            if (!replies_.empty()) return true;
+        }
+#ifndef _WIN32
+        if (closed_cnt_) return true;  // 在 poll 之外关闭的连接，交给下一次 poll 移除
+        if constexpr (UseEpoll) return wait_fd(epfd_, POLLIN, timeout_ms);
+        if constexpr (UseUring) {
+            if (ring_.isOpen()) {
+                if (send_pending_cnt_) return true;  // 待发送列表每次 poll 都要重试
+                return wait_fd(ring_.getFd(), POLLIN, timeout_ms);
+            }
+        }
+#endif
+        if (!pollfds_) pollfds_.reset(new struct pollfd[Conf::MaxConns + 1]);
+        uint32_t n = 0;
+        if (conns_cnt_ < Conf::MaxConns) pollfds_[n++] = {listenfd_, POLLIN, 0};
+        for (uint32_t i = 0; i < conns_cnt_; i++) {
+            Conn& conn = *conns_[i];
+            // 已在外部关闭或高水位回调还没报告，交给下一次 poll 处理
+            if (!conn.isConnected() || conn.send_high_ != conn.send_high_reported_) return true;
+            pollfds_[n++] = {conn.fd_, static_cast<short>(conn.hasSendPending() ? POLLIN | POLLOUT : POLLIN), 0};
+        }
+        return poll_fds(pollfds_.get(), n, timeout_ms) > 0;
+    }
+
+   private:
+    // 一直 accept 到队列为空、连接数满或达到 MaxAcceptPerPoll，返回是否 accept 到了连接 (含 open 失败被关闭的)；
+    // 监听 fd 在 epoll 中是水平触发，没取完的下次 poll 仍会报告
+    template <typename Handler>
+    bool accept(int64_t now, Handler& handler) {
+        uint32_t cnt = 0;
+        while (cnt < conf_max_accept_per_poll<Conf>() && conns_cnt_ < Conf::MaxConns) {
+#ifdef _WIN32
+            // Windows 下仍由 open 逐个设置非阻塞和 TCP_NODELAY
+            socket_t fd = ::accept(listenfd_, nullptr, nullptr);
+            bool accepted = false;
+#else
+            socket_t fd = ::accept4(listenfd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            bool accepted = true;
+#endif
+            if (fd == INVALID_SOCKET_FD) break;
+            cnt++;
+            Conn& conn = *conns_[conns_cnt_];
+            attach(conn);
+            if (!conn.open(now, fd, accepted)) continue;
+#ifndef _WIN32
+            if constexpr (UseEpoll) {
+                struct epoll_event ev;
+                ev.events = EPOLLIN;
+                if constexpr (conf_backend<Conf>() == PollBackend::EpollEdge) ev.events |= EPOLLET;
+                ev.data.ptr = &conn;
+                if (epoll_ctl(epfd_, EPOLL_CTL_ADD, conn.fd_, &ev) < 0) {
+                    conn.close("epoll_ctl add error", true);
+                    continue;
+                }
+            }
+#endif
+            conns_cnt_++;
+            handler.onTcpConnected(conn);
+        }
+        return cnt > 0;
+    }
+
+    // 每次最多取一圈，工作线程持续回复时也不会饿死网络 I/O；写失败 (发送队列满等) 的连接由之后的 poll 移除
+    bool pollReplies() {
+        return replies_.poll([this](ConnHandle h, const uint8_t* data, uint32_t size) {
+            if (Conn* conn = getConn(h)) conn->write(data, size);
+        }) > 0;
+    }
+
+    // 槽位复用时先把旧连接的计数转入 retired_stats_，断开回调中仍然可以读到旧连接的计数
+    void attach(Conn& conn) {
+        if constexpr (conf_stats<Conf>()) {
+            retired_stats_.merge(conn.stats_.snapshot());
+            conn.stats_.reset();
+        }
+        conn.owner_ = this;
+        conn.spill_pool_ = &spill_pool_;
+        conn.bcast_pool_ = &bcast_pool_;
+        conn.wheel_ = &timers_.wheel();
+        conn.on_send_pending_ = [](void* owner, Conn& c) { static_cast<SocketTcpServer*>(owner)->onSendPending(c); };
+        conn.on_closed_ = [](void* owner, Conn& c) { static_cast<SocketTcpServer*>(owner)->onConnClosed(c); };
+    }
+
+#ifdef _WIN32
+    void onSendPending(Conn&) {}
+    void onConnClosed(Conn&) {}
+#else
+    template <typename Handler>
+    bool pollEpoll(int64_t now, Handler& handler) {
+        struct epoll_event events[conf_max_events<Conf>()];
+        int n = epoll_wait(epfd_, events, conf_max_events<Conf>(), 0);
+        for (int i = 0; i < n; i++) {
+            Conn* conn = static_cast<Conn*>(events[i].data.ptr);
+            if (!conn) {
+                accept(now, handler);
+                continue;
+            }
+            // 已被本批次中其他连接的回调关闭
+            if (!conn->isConnected()) continue;
+            if (events[i].events & ~EPOLLOUT)
+                conn->template pollConn<Backend == PollBackend::EpollEdge>(now, handler);
+            else
+                conn->pollSend(now, handler);
+            if (conn->isConnected() && conn->epoll_out_ && !conn->hasSendPending()) epollMod(*conn, false);
+        }
+        return removeClosed(handler) || n > 0;
+    }
+
+    bool epollMod(Conn& conn, bool out) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        if constexpr (Backend == PollBackend::EpollEdge) ev.events |= EPOLLET;
+        if (out) ev.events |= EPOLLOUT;
+        ev.data.ptr = &conn;
+        if (epoll_ctl(epfd_, EPOLL_CTL_MOD, conn.fd_, &ev) < 0) return false;
+        conn.epoll_out_ = out;
+        return true;
+    }
+
+    // 发送队列由空变为非空: epoll 注册 EPOLLOUT，io_uring 加入待发送列表在每次 poll 时发送，Scan 在 pollConn 中发送
+    void onSendPending(Conn& conn) {
+        if constexpr (UseEpoll) {
+            // 零拷贝完成通知通过 EPOLLERR 报告，只有发送队列非空时才需要 EPOLLOUT
+            if (!conn.epoll_out_ && conn.getSendQueued()) epollMod(conn, true);
+        }
+        if constexpr (UseUring) {
+            if (ring_.isOpen() && !conn.send_listed_) {
+                conn.send_listed_ = true;
+                send_pending_[send_pending_cnt_++] = &conn;
+            }
+        }
+    }
+
+    template <typename Handler>
+    void pollSendPending(int64_t now, Handler& handler) {
+        for (uint32_t i = 0; i < send_pending_cnt_;) {
+            Conn& conn = *send_pending_[i];
+            if (conn.isConnected() && conn.hasZeroCopyPending()) conn.pollZeroCopy(handler);
+            if (conn.isConnected()) conn.pollSend(now, handler);
+            if (conn.isConnected() && (conn.hasSendPending() || conn.hasZeroCopyPending())) {
+                i++;
+                continue;
+            }
+            conn.send_listed_ = false;
+            send_pending_[i] = send_pending_[--send_pending_cnt_];
+        }
+    }
+
+    // epoll/io_uring 只处理有事件的连接，连接无论在哪里关闭 (自身事件、其他连接的回调、pollReplies、poll 之外)
+    // 都先记入已关闭列表，由 removeClosed 在本次 poll 结束前统一移除
+    void onConnClosed(Conn& conn) {
+        if constexpr (UseEpoll || UseUring) {
+            if ((UseEpoll || ring_.isOpen()) && !conn.close_listed_) {
+                conn.close_listed_ = true;
+                closed_[closed_cnt_++] = &conn;
+            }
+        }
+    }
+
+    // 返回是否移除了连接；onTcpDisconnect 中关闭的其他连接会追加到列表，一并移除。
+    // 槽位在同一次 poll 中被新连接复用时仍处于连接状态，跳过；open 失败的连接不在 conns_ 中，removeConn 找不到
+    template <typename Handler>
+    bool removeClosed(Handler& handler) {
+        bool removed = false;
+        while (closed_cnt_) {
+            Conn& conn = *closed_[--closed_cnt_];
+            conn.close_listed_ = false;
+            if (!conn.isConnected()) removed |= removeConn(conn, handler);
+        }
+        return removed;
+    }
+
+    // 返回 conn 是否在 conns_ 中并被移除
+    template <typename Handler>
+    bool removeConn(Conn& conn, Handler& handler) {
+        for (uint32_t i = 0; i < conns_cnt_; i++) {
+            if (conns_[i] == &conn) {
+                std::swap(conns_[i], conns_[--conns_cnt_]);
+                detach(conn);
+                handler.onTcpDisconnect(conn);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 关闭的 fd 会被内核自动移出 epoll；io_uring 则需要取消 multishot recv 并清空注册文件槽位，
+    // 否则 ring 持有的引用会让 socket 一直不真正关闭
+    void detach(Conn& conn) {
+        if constexpr (UseUring) {
+            if (!ring_.isOpen()) return;
+            uint32_t idx = &conn - conns_data_;
+            // getSqe 在 SQ 满时已经提交过一次，仍然取不到时 (如提交被内核暂时拒绝) 再提交重试，不能漏掉取消
+            struct io_uring_sqe* sqe = ring_.getSqe();
+            for (int i = 0; !sqe && i < 3 && ring_.submit() >= 0; i++) sqe = ring_.getSqe();
+            if (sqe) {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = -1;
+                sqe->addr = uringData(UringRecv, idx, uring_gen_[idx]);
+                sqe->user_data = uringData(UringCancel, 0, 0);
+            } else {
+                saveError("io_uring cancel recv error");
+            }
+            ring_.updateFile(idx, -1);
+            uring_gen_[idx]++;  // 之后到达的旧 CQE 会因 generation 不匹配被忽略
+        }
+    }
+
+    enum : uint64_t { UringAccept = 1, UringRecv = 2, UringCancel = 3 };
+
+    static uint64_t uringData(uint64_t type, uint32_t idx, uint32_t gen) {
+        return type << 56 | static_cast<uint64_t>(gen) << 24 | idx;
+    }
+
+    // 连接槽位 [0, MaxConns) 对应 conns_data_ 下标，槽位 MaxConns 为监听 fd
+    bool initUring() {
+        constexpr uint32_t buf_cnt = conf_uring_buf_cnt<Conf>();
+        static_assert((buf_cnt & (buf_cnt - 1)) == 0, "UringBufCnt must be a power of 2");
+        if (!ring_.init(64, 2 * std::bit_ceil(buf_cnt + Conf::MaxConns + 1))) return false;
+        if (!ring_.registerFiles(Conf::MaxConns + 1)) return false;
+        if (!ring_.updateFile(Conf::MaxConns, listenfd_)) return false;
+        uring_bufs_.reset(new uint8_t[static_cast<size_t>(buf_cnt) * Conf::RecvBufSize]);
+        if (!ring_.setupBufRing(uring_bufs_.get(), buf_cnt, Conf::RecvBufSize)) return false;
+        if (!armAccept()) return false;
+        return ring_.submit() >= 0;
+    }
+
+    bool armAccept() {
+        struct io_uring_sqe* sqe = ring_.getSqe();
+        if (!sqe) return false;
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = Conf::MaxConns;
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        sqe->user_data = uringData(UringAccept, 0, 0);
+        return true;
+    }
+
+    bool armRecv(uint32_t idx) {
+        struct io_uring_sqe* sqe = ring_.getSqe();
+        if (!sqe) return false;
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = idx;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->buf_group = 0;
+        sqe->user_data = uringData(UringRecv, idx, uring_gen_[idx]);
+        return true;
+    }
+
+    // 所有 CQE 直接从共享内存读取，每次 poll 最多一次 io_uring_enter (有新的 SQE 时)
+    template <typename Handler>
+    bool pollUring(int64_t now, Handler& handler) {
+        uint32_t cnt = ring_.forEachCqe([&](const struct io_uring_cqe& cqe) {
+            uint64_t type = cqe.user_data >> 56;
+            if (type == UringAccept) {
+                if (cqe.res >= 0) uringAccept(now, cqe.res, handler);
+                if (!IoUring::hasMore(cqe) && !isClosed()) armAccept();
+            } else if (type == UringRecv) {
+                uringRecv(now, cqe, handler);
+            }
+            if (IoUring::hasBuf(cqe)) ring_.recycleBuf(IoUring::bufId(cqe));
+        });
+        ring_.commitBufs();
+        if (send_pending_cnt_) pollSendPending(now, handler);
+        bool removed = removeClosed(handler);
+        ring_.submit();
+        return cnt > 0 || removed;
+    }
+
+    // multishot accept 不受 MaxConns 限制，连接数满时直接关闭新连接
     template <typename Handler>
-    void foreachConn(Handler handler) {
-        for (uint32_t i = 0; i < conns_cnt_; i++) {
-            Conn& conn = *conns_[i];
-            handler(conn);
+    void uringAccept(int64_t now, socket_t fd, Handler& handler) {
+        if (conns_cnt_ >= Conf::MaxConns) {
+            close_socket(fd);
+            return;
+        }
+        Conn& conn = *conns_[conns_cnt_];
+        attach(conn);
+        if (!conn.open(now, fd, true)) return;
+        uint32_t idx = &conn - conns_data_;
+        if (!ring_.updateFile(idx, fd)) {
+            conn.close("io_uring register file error", true);
+            return;
         }
+        if (!armRecv(idx)) {
+            ring_.updateFile(idx, -1);
+            conn.close("io_uring sq full");
+            return;
+        }
+        conns_cnt_++;
+        handler.onTcpConnected(conn);
     }
 
     template <typename Handler>
-    void poll(Handler& handler) {
-        int64_t now = time(0);
-        if (conns_cnt_ < Conf::MaxConns) {
-            Conn& conn = *conns_[conns_cnt_];
-            struct sockaddr_in clientaddr;
-            socklen_t addr_len = sizeof(clientaddr);
-            socket_t fd = ::accept(listenfd_, (struct sockaddr*)&(clientaddr), &addr_len);
-            if (fd != INVALID_SOCKET_FD && conn.open(now, fd)) {
-                conns_cnt_++;
-                handler.onTcpConnected(conn);
-            }
-        }
-        for (uint32_t i = 0; i < conns_cnt_;) {
-            Conn& conn = *conns_[i];
-            conn.pollConn(now, handler);
-            if (conn.isConnected())
-                i++;
-            else {
-                std::swap(conns_[i], conns_[--conns_cnt_]);
-                handler.onTcpDisconnect(conn);
-            }
+    void uringRecv(int64_t now, const struct io_uring_cqe& cqe, Handler& handler) {
+        uint32_t idx = cqe.user_data & 0xffffff;
+        uint32_t gen = (cqe.user_data >> 24) & 0xffffffff;
+        Conn& conn = conns_data_[idx];
+        if (gen != uring_gen_[idx] || !conn.isConnected()) return;
+        if (cqe.res > 0)
+            conn.pollData(now, ring_.getBuf(IoUring::bufId(cqe)), cqe.res, handler);
+        else if (cqe.res == 0)
+            conn.close("remote close");
+        else if (cqe.res != -ENOBUFS) {
+            errno = -cqe.res;
+            conn.close("read error", true);
         }
+        if (conn.isConnected() && !IoUring::hasMore(cqe) && !armRecv(idx)) conn.close("io_uring sq full");
     }
+#endif
 
-   private:
     void saveError(const char* msg) {
         int err = get_last_error();
 #ifdef _WIN32
@@ -444,19 +2454,100 @@ class SocketTcpServer {
     }
 
     socket_t listenfd_ = INVALID_SOCKET_FD;
+#ifndef _WIN32
+    int epfd_ = -1;
+    IoUring ring_;
+    std::unique_ptr<uint8_t[]> uring_bufs_;
+    uint32_t uring_gen_[UseUring ? Conf::MaxConns : 1] = {};
+    uint32_t send_pending_cnt_ = 0;
+    Conn* send_pending_[UseUring ? Conf::MaxConns : 1];
+    // 每个连接至多在列表中出现一次，须在 conns_data_ 之后析构，连接析构时仍会加入列表
+    uint32_t closed_cnt_ = 0;
+    Conn* closed_[UseEpoll || UseUring ? Conf::MaxConns : 1];
+#endif
     uint32_t conns_cnt_ = 0;
     Conn* conns_[Conf::MaxConns];
+    // Scan 后端 wait 时使用，第一次调用时分配
+    std::unique_ptr<struct pollfd[]> pollfds_;
+    // 以下三者须在 conns_data_ 之前构造、之后析构，连接析构时会取消定时器、归还借用的大缓冲和共享数据
+    SocketTimers<Conf> timers_;
+    SpillPool spill_pool_{conf_spill_buf_size<Conf>(), conf_recv_buf_mode<Conf>() == RecvBufMode::Spill ? conf_spill_buf_cnt<Conf>() : 0};
+    SharedPayloadPool bcast_pool_{conf_broadcast_buf_cnt<Conf>()};
+    struct NoReplyQueue {};
+    [[no_unique_address]] std::conditional_t<(ReplyQueueLen > 0), MpscMsgQueue<conf_reply_max_size<Conf>(), ReplyQueueLen>,
+                                             NoReplyQueue> replies_;
     Conn conns_data_[Conf::MaxConns];
+    [[no_unique_address]] SocketStatsRecorder<conf_stats<Conf>()> retired_stats_;
     char last_error_[64] = "";
 };
 
-template <uint32_t RecvBufSize = 1500>
+// 批量接收时交给 handler 的单个数据报，ts 在 init 开启 timestamping 时有效 (GRO 拆出的数据报共用一个时间戳)
+struct UdpDatagram {
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+    const sockaddr_in* src_addr = nullptr;
+    RxTimestamp ts = {};
+};
+
+// read/recvfrom 的 handler 可以多接收一个 const RxTimestamp& 参数，不接收时按原来的参数回调
+template <typename Handler>
+inline void udp_call_read(Handler& handler, const UdpDatagram& d) {
+    if constexpr (requires { handler(d.data, d.size, d.ts); })
+        handler(d.data, d.size, d.ts);
+    else
+        handler(d.data, d.size);
+}
+
+template <typename Handler>
+inline void udp_call_recvfrom(Handler& handler, const UdpDatagram& d) {
+    if constexpr (requires { handler(d.data, d.size, *d.src_addr, d.ts); })
+        handler(d.data, d.size, *d.src_addr, d.ts);
+    else
+        handler(d.data, d.size, *d.src_addr);
+}
+
+// 开启 UDP_GRO 时接收缓冲至少要放得下一个最大的 UDP 超级包
+constexpr uint32_t UdpGroRecvBufSize = 65535;
+
+// BatchSize > 1 时 read/recvfrom 使用 recvmmsg 一次收取最多 BatchSize 个数据报，逐个回调 handler
+// init 时开启 gro (需要 RecvBufSize >= UdpGroRecvBufSize)，内核合并的超级包会按分段大小拆回原始数据报再回调
+// init 时开启 timestamping 后，read/recvfrom 的 handler 可以多接收一个 const RxTimestamp& 参数:
+// handler(data, size, ts) / handler(data, size, src_addr, ts)，不接收的 handler 照常回调
+
+template <uint32_t RecvBufSize = 1500, PollBackend Backend = PollBackend::Scan, uint32_t BatchSize = 1, bool Stats = false>
 class SocketUdpReceiver {
+    static constexpr bool UseUring = Backend == PollBackend::IoUring;
+#ifdef _WIN32
+    static_assert(Backend == PollBackend::Scan, "io_uring backend is only available on Linux");
+#else
+    static_assert(Backend == PollBackend::Scan || UseUring, "udp receiver supports Scan or IoUring backend");
+#endif
+    static_assert(BatchSize >= 1, "BatchSize must be at least 1");
+    static_assert(BatchSize == 1 || !UseUring, "io_uring backend already batches completions");
+
    public:
     bool init(const char* interface_ip, const char* dest_ip, uint16_t dest_port,
-              const char* subscribe_ip = "") {
+              const char* subscribe_ip = "", bool gro = false, TimestampMode timestamping = TimestampMode::None) {
         ensure_network_init();  // 触发全局一次性的 WSAStartup (Windows)
 
+#ifdef _WIN32
+        if (gro) {
+            snprintf(last_error_, sizeof(last_error_), "UDP_GRO is only available on Linux");
+            return false;
+        }
+        if (timestamping != TimestampMode::None) {
+            snprintf(last_error_, sizeof(last_error_), "SO_TIMESTAMPING is only available on Linux");
+            return false;
+        }
+#else
+        if (gro && RecvBufSize < UdpGroRecvBufSize) {
+            snprintf(last_error_, sizeof(last_error_), "UDP_GRO requires RecvBufSize >= %u", UdpGroRecvBufSize);
+            return false;
+        }
+        gro_ = gro;
+        timestamping_ = timestamping != TimestampMode::None;
+#endif
+
         if ((fd_ = socket(AF_INET, SOCK_DGRAM, 0)) == INVALID_SOCKET_FD) {
             saveError("socket error");
             return false;
@@ -495,6 +2586,29 @@ class SocketUdpReceiver {
             }
         }
 
+#ifndef _WIN32
+        if (gro_ && setsockopt(fd_, SOL_UDP, UDP_GRO, &optval, sizeof(optval)) < 0) {
+            close("setsockopt UDP_GRO failed");
+            return false;
+        }
+        if (timestamping_ && !set_rx_timestamping(fd_, timestamping)) {
+            close("setsockopt SO_TIMESTAMPING failed");
+            return false;
+        }
+        if constexpr (UseUring) {
+            if (!initUring()) ring_.close();  // 内核不支持时退回 recv
+        }
+        for (uint32_t i = 0; i < BatchSize; i++) {
+            iovs_[i].iov_base = buf[i];
+            iovs_[i].iov_len = RecvBufSize;
+            memset(&msgs_[i], 0, sizeof(msgs_[i]));
+            msgs_[i].msg_hdr.msg_name = &addrs_[i];
+            msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+            if (useControl()) msgs_[i].msg_hdr.msg_control = control_[i];
+        }
+#endif
+
         return true;
     }
 
@@ -510,6 +2624,9 @@ class SocketUdpReceiver {
 
     const char* getLastError() { return last_error_; }
 
+    // Stats 为 true 时有效，可以在其他线程调用
+    SocketStats getStats() const { return stats_.snapshot(); }
+
     bool isClosed() { return fd_ == INVALID_SOCKET_FD; }
 
     void close(const char* reason) {
@@ -518,32 +2635,143 @@ class SocketUdpReceiver {
             close_socket(fd_);
             fd_ = INVALID_SOCKET_FD;
         }
+#ifndef _WIN32
+        ring_.close();
+#endif
+    }
+
+    // init 之后调用，对 recv/recvmmsg 以及 wait 生效，见 set_busy_poll
+    bool setBusyPoll(uint32_t usec, bool prefer = false) {
+#ifdef _WIN32
+        snprintf(last_error_, sizeof(last_error_), "SO_BUSY_POLL is only available on Linux");
+        return false;
+#else
+        if (!set_busy_poll(fd_, usec, prefer)) {
+            saveError("setsockopt SO_BUSY_POLL failed");
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    // 阻塞最多 timeout_ms 直到有数据报到达，返回是否就绪，之后调用 read/recvfrom 处理
+    bool wait(int timeout_ms) {
+#ifndef _WIN32
+        if constexpr (UseUring) {
+            if (ring_.isOpen()) return wait_fd(ring_.getFd(), POLLIN, timeout_ms);
+        }
+#endif
+        return wait_fd(fd_, POLLIN, timeout_ms);
     }
 
+    // io_uring 模式下一次调用会处理所有已到达的数据报，每个数据报回调一次
     template <typename Handler>
     bool read(Handler handler) {
+#ifndef _WIN32
+        if constexpr (UseUring) {
+            if (ring_.isOpen()) return pollUring([&](const UdpDatagram& d) { udp_call_read(handler, d); });
+        }
+#endif
+        if (BatchSize > 1 || useControl()) {
+            return recvmmsg([&](std::span<const UdpDatagram> dgrams) {
+                for (const UdpDatagram& d : dgrams) udp_call_read(handler, d);
+            }) > 0;
+        }
         // 跨平台统一使用 recv 替代原先的 read
-        int n = ::recv(fd_, reinterpret_cast<char*>(buf), RecvBufSize, 0);
+        int n = ::recv(fd_, reinterpret_cast<char*>(buf[0]), RecvBufSize, 0);
         if (n > 0) {
-            handler(buf, n);
+            received(n);
+            timed([&] { udp_call_read(handler, {buf[0], static_cast<uint32_t>(n), nullptr}); });
             return true;
         }
+        if (n < 0 && is_would_block(get_last_error())) stats_.recvEagain();
         return false;
     }
 
     template <typename Handler>
     bool recvfrom(Handler handler) {
+#ifndef _WIN32
+        if constexpr (UseUring) {
+            if (ring_.isOpen()) return pollUring([&](const UdpDatagram& d) { udp_call_recvfrom(handler, d); });
+        }
+#endif
+        if (BatchSize > 1 || useControl()) {
+            return recvmmsg([&](std::span<const UdpDatagram> dgrams) {
+                for (const UdpDatagram& d : dgrams) udp_call_recvfrom(handler, d);
+            }) > 0;
+        }
         struct sockaddr_in src_addr;
         socklen_t addrlen = sizeof(src_addr);
-        int n = ::recvfrom(fd_, reinterpret_cast<char*>(buf), RecvBufSize, 0,
+        int n = ::recvfrom(fd_, reinterpret_cast<char*>(buf[0]), RecvBufSize, 0,
                            reinterpret_cast<struct sockaddr*>(&src_addr), &addrlen);
         if (n > 0) {
-            handler(buf, n, src_addr);
+            received(n);
+            timed([&] { udp_call_recvfrom(handler, {buf[0], static_cast<uint32_t>(n), &src_addr}); });
             return true;
         }
+        if (n < 0 && is_would_block(get_last_error())) stats_.recvEagain();
         return false;
     }
 
+    // 一次系统调用收取最多 BatchSize 个数据报，handler(std::span<const UdpDatagram>) 只回调一次，
+    // 返回收到的数据报个数。数据在下一次接收前有效。GRO 拆包后超过 BatchSize 个时会分多次回调
+    template <typename Handler>
+    uint32_t recvmmsg(Handler handler) {
+        UdpDatagram dgrams[BatchSize];
+        uint32_t cnt = 0;
+        auto deliver = [&] { timed([&] { handler(std::span<const UdpDatagram>(dgrams, cnt)); }); };
+#ifdef _WIN32
+        for (; cnt < BatchSize; cnt++) {
+            int addrlen = sizeof(addrs_[cnt]);
+            int n = ::recvfrom(fd_, reinterpret_cast<char*>(buf[cnt]), RecvBufSize, 0,
+                               reinterpret_cast<struct sockaddr*>(&addrs_[cnt]), &addrlen);
+            if (n <= 0) {
+                if (cnt == 0 && n < 0 && is_would_block(get_last_error())) stats_.recvEagain();
+                break;
+            }
+            received(n);
+            dgrams[cnt] = {buf[cnt], static_cast<uint32_t>(n), &addrs_[cnt]};
+        }
+#else
+        for (uint32_t i = 0; i < BatchSize; i++) {
+            msgs_[i].msg_hdr.msg_namelen = sizeof(addrs_[i]);
+            if (useControl()) msgs_[i].msg_hdr.msg_controllen = sizeof(control_[i]);
+        }
+        int n = ::recvmmsg(fd_, msgs_, BatchSize, 0, nullptr);
+        if (n <= 0) {
+            if (n < 0 && is_would_block(get_last_error())) stats_.recvEagain();
+            return 0;
+        }
+        if (!gro_) {
+            for (; cnt < static_cast<uint32_t>(n); cnt++) {
+                received(msgs_[cnt].msg_len);
+                dgrams[cnt] = {buf[cnt], msgs_[cnt].msg_len, &addrs_[cnt]};
+                if (timestamping_) parse_rx_timestamp(msgs_[cnt].msg_hdr, dgrams[cnt].ts);
+            }
+        } else {
+            uint32_t total = 0;
+            for (int i = 0; i < n; i++) {
+                stats_.recvBuffered(msgs_[i].msg_len);
+                RxTimestamp ts;
+                if (timestamping_) parse_rx_timestamp(msgs_[i].msg_hdr, ts);
+                splitGro(buf[i], msgs_[i].msg_len, groSize(msgs_[i].msg_hdr), [&](const uint8_t* data, uint32_t size) {
+                    if (cnt == BatchSize) {
+                        deliver();
+                        total += cnt;
+                        cnt = 0;
+                    }
+                    stats_.received(size);
+                    dgrams[cnt++] = {data, size, &addrs_[i], ts};
+                });
+            }
+            if (cnt) deliver();
+            return total + cnt;
+        }
+#endif
+        if (cnt) deliver();
+        return cnt;
+    }
+
     bool sendto(const void* data, uint32_t size, const sockaddr_in& dst_addr) {
         return ::sendto(fd_, reinterpret_cast<const char*>(data), size, 0,
                         reinterpret_cast<const struct sockaddr*>(&dst_addr), sizeof(dst_addr)) == static_cast<int>(size);
@@ -559,12 +2787,384 @@ class SocketUdpReceiver {
 #endif
     }
 
+    void received(uint32_t size) {
+        stats_.received(size);
+        stats_.recvBuffered(size);
+    }
+
+    template <typename Callback>
+    void timed(Callback&& cb) {
+        int64_t begin = stats_.handlerBegin();
+        cb();
+        stats_.handlerEnd(begin);
+    }
+
+#ifdef _WIN32
+    bool useControl() { return false; }
+#else
+    // GRO 分段大小和时间戳都通过 cmsg 返回，需要走 recvmsg/recvmmsg
+    bool useControl() { return gro_ || timestamping_; }
+
+    // UDP_GRO cmsg 中的分段大小，没有 cmsg 时说明未被合并
+    static uint32_t groSize(struct msghdr& msg) {
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                int seg;
+                memcpy(&seg, CMSG_DATA(cm), sizeof(seg));
+                return seg;
+            }
+        }
+        return 0;
+    }
+
+    // 按分段大小拆回原始数据报，最后一个可以更短
+    template <typename Handler>
+    static void splitGro(const uint8_t* data, uint32_t size, uint32_t seg, Handler&& handler) {
+        if (seg == 0 || seg >= size) {
+            handler(data, size);
+            return;
+        }
+        for (uint32_t off = 0; off < size; off += seg) handler(data + off, std::min(seg, size - off));
+    }
+
+    static constexpr uint32_t GroControlSize = CMSG_SPACE(sizeof(int));
+    static constexpr uint32_t ControlSize = GroControlSize + RxTimestampControlSize;
+    static constexpr uint32_t UringBufCnt = 256;
+    static constexpr uint32_t UringBufSize =
+        sizeof(struct io_uring_recvmsg_out) + sizeof(sockaddr_in) + ControlSize + RecvBufSize;
+
+    // 注册文件槽位 0 为 fd_，multishot recvmsg 每个数据报占用一个 provided buffer:
+    // [io_uring_recvmsg_out][sockaddr_in][payload]
+    bool initUring() {
+        if (!ring_.init(8, 2 * UringBufCnt)) return false;
+        if (!ring_.registerFiles(1) || !ring_.updateFile(0, fd_)) return false;
+        uring_bufs_.reset(new uint8_t[UringBufCnt * UringBufSize]);
+        if (!ring_.setupBufRing(uring_bufs_.get(), UringBufCnt, UringBufSize)) return false;
+        memset(&uring_msg_, 0, sizeof(uring_msg_));
+        uring_msg_.msg_namelen = sizeof(sockaddr_in);
+        if (useControl()) uring_msg_.msg_controllen = ControlSize;
+        if (!armRecv()) return false;
+        return ring_.submit() >= 0;
+    }
+
+    bool armRecv() {
+        struct io_uring_sqe* sqe = ring_.getSqe();
+        if (!sqe) return false;
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = 0;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->addr = reinterpret_cast<uint64_t>(&uring_msg_);
+        sqe->len = 1;
+        sqe->buf_group = 0;
+        return true;
+    }
+
+    // handler(const UdpDatagram&)
+    template <typename Handler>
+    bool pollUring(Handler&& handler) {
+        bool got_data = false;
+        bool rearm = false;
+        int err = 0;
+        ring_.forEachCqe([&](const struct io_uring_cqe& cqe) {
+            if (cqe.res > 0 && IoUring::hasBuf(cqe)) {
+                uint8_t* b = ring_.getBuf(IoUring::bufId(cqe));
+                auto* out = reinterpret_cast<struct io_uring_recvmsg_out*>(b);
+                const auto& src_addr = *reinterpret_cast<const sockaddr_in*>(out + 1);
+                uint8_t* control = b + sizeof(*out) + uring_msg_.msg_namelen;
+                const uint8_t* payload = control + uring_msg_.msg_controllen;
+                uint32_t size = std::min(out->payloadlen, RecvBufSize);
+                stats_.recvBuffered(size);
+                struct msghdr msg;
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_control = control;
+                msg.msg_controllen = out->controllen;
+                UdpDatagram d = {payload, size, &src_addr};
+                if (timestamping_) parse_rx_timestamp(msg, d.ts);
+                splitGro(payload, size, gro_ ? groSize(msg) : 0, [&](const uint8_t* data, uint32_t size) {
+                    d.data = data;
+                    d.size = size;
+                    stats_.received(size);
+                    timed([&] { handler(d); });
+                });
+                got_data = true;
+            }
+            if (IoUring::hasBuf(cqe)) ring_.recycleBuf(IoUring::bufId(cqe));
+            // ENOBUFS 只是 buffer 暂时用完，重新 arm 即可；其他错误重新 arm 也会一直失败
+            if (cqe.res < 0 && cqe.res != -ENOBUFS)
+                err = -cqe.res;
+            else if (!IoUring::hasMore(cqe))
+                rearm = true;
+        });
+        ring_.commitBufs();
+        if (err) {
+            errno = err;
+            close("io_uring recvmsg error");  // 遍历 CQE 时不能关闭 ring
+            return got_data;
+        }
+        if (rearm && !isClosed()) armRecv();
+        ring_.submit();
+        return got_data;
+    }
+
+    IoUring ring_;
+    std::unique_ptr<uint8_t[]> uring_bufs_;
+    struct msghdr uring_msg_;
+    struct mmsghdr msgs_[BatchSize];
+    struct iovec iovs_[BatchSize];
+    alignas(struct cmsghdr) uint8_t control_[BatchSize][ControlSize];
+    bool gro_ = false;
+    bool timestamping_ = false;
+#endif
+
+    socket_t fd_ = INVALID_SOCKET_FD;
+    uint8_t buf[BatchSize][RecvBufSize];
+    struct sockaddr_in addrs_[BatchSize];
+    char last_error_[64] = "";
+    [[no_unique_address]] SocketStatsRecorder<Stats> stats_;
+};
+
+#ifndef _WIN32
+// AF_PACKET + TPACKET_V3 mmap 环形缓冲接收 UDP (仅 Linux，需要 CAP_NET_RAW)。
+// 内核把包按 block 批量写入共享内存，读取时不需要系统调用，适合接收组播行情的突发流量；
+// block 在写满或超过 block_timeout_ms 后才交给用户态，包少时延迟最多为该超时。
+// 过滤由挂在 socket 上的 CBPF 程序完成 (IPv4 UDP、目的 ip:port)，分片的数据报直接丢弃，不做重组。
+// handler 与 SocketUdpReceiver 相同，数据直接指向 ring 中的包，只在回调期间有效；ts 为内核收包时间
+// (网卡打了硬件时间戳时为 hw_ns)
+template <uint32_t BlockSize = 1 << 20, uint32_t BlockCnt = 64>
+class SocketPacketRingReceiver {
+    static_assert(BlockSize % 4096 == 0, "BlockSize must be a multiple of the page size");
+    static constexpr uint32_t FrameSize = 2048;
+    static constexpr size_t RingSize = static_cast<size_t>(BlockSize) * BlockCnt;
+
+   public:
+    // interface_name 为网卡名 (如 "eth0"、"lo")，为空时接收所有网卡；dest_ip 为 "0.0.0.0" 时不按目的 ip 过滤；
+    // subscribe_ip 非空时与 SocketUdpReceiver 一样在该网卡上加入 dest_ip 组播组，否则网卡可能不接收该组的包
+    bool init(const char* interface_name, const char* dest_ip, uint16_t dest_port, const char* subscribe_ip = "",
+              uint32_t block_timeout_ms = 1) {
+        struct in_addr dest_addr;
+        if (inet_pton(AF_INET, dest_ip, &dest_addr) != 1) {
+            snprintf(last_error_, sizeof(last_error_), "invalid dest_ip");
+            return false;
+        }
+
+        // protocol 为 0 时 bind 之前不收任何包，先挂好过滤器和 ring 再 bind
+        if ((fd_ = socket(AF_PACKET, SOCK_RAW, 0)) < 0) {
+            saveError("socket error");
+            return false;
+        }
+
+        if (!attachFilter(dest_addr.s_addr, dest_port)) {
+            close("setsockopt SO_ATTACH_FILTER error");
+            return false;
+        }
+
+        int ver = TPACKET_V3;
+        if (setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &ver, sizeof(ver)) < 0) {
+            close("setsockopt PACKET_VERSION error");
+            return false;
+        }
+
+#ifdef PACKET_IGNORE_OUTGOING
+        // loopback 上同一个包发出和收到时各出现一次，只要收到的；旧内核不支持时在解析时按 sll_pkttype 过滤
+        int yes = 1;
+        setsockopt(fd_, SOL_PACKET, PACKET_IGNORE_OUTGOING, &yes, sizeof(yes));
+#endif
+
+        struct tpacket_req3 req;
+        memset(&req, 0, sizeof(req));
+        req.tp_block_size = BlockSize;
+        req.tp_block_nr = BlockCnt;
+        req.tp_frame_size = FrameSize;
+        req.tp_frame_nr = BlockSize / FrameSize * BlockCnt;
+        req.tp_retire_blk_tov = block_timeout_ms;
+        if (setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+            close("setsockopt PACKET_RX_RING error");
+            return false;
+        }
+
+        void* p = mmap(nullptr, RingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+        if (p == MAP_FAILED) {
+            close("mmap rx ring error");
+            return false;
+        }
+        ring_ = static_cast<uint8_t*>(p);
+        block_idx_ = 0;
+
+        struct sockaddr_ll ll;
+        memset(&ll, 0, sizeof(ll));
+        ll.sll_family = AF_PACKET;
+        ll.sll_protocol = htons(ETH_P_IP);
+        if (interface_name[0] && (ll.sll_ifindex = if_nametoindex(interface_name)) == 0) {
+            close("if_nametoindex error");
+            return false;
+        }
+        if (::bind(fd_, reinterpret_cast<struct sockaddr*>(&ll), sizeof(ll)) < 0) {
+            close("bind error");
+            return false;
+        }
+
+        if (subscribe_ip[0]) {
+            struct ip_mreq group;
+            inet_pton(AF_INET, subscribe_ip, &(group.imr_interface));
+            group.imr_multiaddr = dest_addr;
+            if ((mcast_fd_ = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ||
+                setsockopt(mcast_fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group, sizeof(group)) < 0) {
+                close("setsockopt IP_ADD_MEMBERSHIP failed");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    ~SocketPacketRingReceiver() { close("destruct"); }
+
+    const char* getLastError() { return last_error_; }
+
+    bool isClosed() { return fd_ == INVALID_SOCKET_FD; }
+
+    // 阻塞最多 timeout_ms 直到有 block 交给用户态 (写满或 block_timeout_ms 到期)，返回是否就绪
+    bool wait(int timeout_ms) { return wait_fd(fd_, POLLIN, timeout_ms); }
+
+    void close(const char* reason) {
+        if (fd_ != INVALID_SOCKET_FD) {
+            saveError(reason);
+            ::close(fd_);
+            fd_ = INVALID_SOCKET_FD;
+        }
+        if (mcast_fd_ >= 0) {
+            ::close(mcast_fd_);
+            mcast_fd_ = -1;
+        }
+        if (ring_) {
+            munmap(ring_, RingSize);
+            ring_ = nullptr;
+        }
+    }
+
+    // 处理所有已交给用户态的 block，每个数据报回调一次
+    template <typename Handler>
+    bool read(Handler handler) {
+        return pollRing([&](const UdpDatagram& d) { udp_call_read(handler, d); });
+    }
+
+    template <typename Handler>
+    bool recvfrom(Handler handler) {
+        return pollRing([&](const UdpDatagram& d) { udp_call_recvfrom(handler, d); });
+    }
+
+    // 自上次调用以来因 ring 没有空闲 block 被内核丢弃的包数
+    uint32_t getDrops() {
+        struct tpacket_stats_v3 st;
+        socklen_t len = sizeof(st);
+        if (getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &st, &len) < 0) return 0;
+        return st.tp_drops;
+    }
+
+   private:
+    void saveError(const char* msg) { snprintf(last_error_, sizeof(last_error_), "%s %s", msg, strerror(errno)); }
+
+    // 相当于 tcpdump "udp and dst host <ip> and dst port <port>" 再去掉分片，偏移按 14 字节以太网头计算
+    bool attachFilter(in_addr_t ip_be, uint16_t port) {
+        struct sock_filter code[13];
+        uint32_t n = 0;
+        uint32_t drop_jf[4];  // 不匹配时跳到末尾 ret #0，最后回填偏移
+        uint32_t drop_jf_cnt = 0;
+        auto jeq = [&](uint32_t k) {
+            drop_jf[drop_jf_cnt++] = n;
+            code[n++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, k, 0, 0);
+        };
+        code[n++] = BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12);  // ethertype
+        jeq(ETH_P_IP);
+        code[n++] = BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 23);  // ip protocol
+        jeq(IPPROTO_UDP);
+        code[n++] = BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 20);  // MF 标志和分片偏移
+        uint32_t frag = n;
+        code[n++] = BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x3fff, 0, 0);
+        if (ip_be != INADDR_ANY) {
+            code[n++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 30);  // 目的 ip
+            jeq(ntohl(ip_be));
+        }
+        code[n++] = BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 14);  // x = ip 头长度
+        code[n++] = BPF_STMT(BPF_LD | BPF_H | BPF_IND, 16);   // 目的端口
+        jeq(port);
+        code[n++] = BPF_STMT(BPF_RET | BPF_K, 0xffffffff);
+        code[n++] = BPF_STMT(BPF_RET | BPF_K, 0);
+        for (uint32_t i = 0; i < drop_jf_cnt; i++) code[drop_jf[i]].jf = n - 2 - drop_jf[i];
+        code[frag].jt = n - 2 - frag;
+
+        struct sock_fprog prog;
+        prog.len = n;
+        prog.filter = code;
+        return setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0;
+    }
+
+    // block_status 由内核和用户态交替拥有: TP_STATUS_USER 时归用户态，处理完写回 TP_STATUS_KERNEL
+    template <typename Handler>
+    bool pollRing(Handler&& handler) {
+        bool got_data = false;
+        while (ring_) {
+            auto* block = reinterpret_cast<struct tpacket_block_desc*>(ring_ + static_cast<size_t>(block_idx_) * BlockSize);
+            std::atomic_ref<uint32_t> status(block->hdr.bh1.block_status);
+            if (!(status.load(std::memory_order_acquire) & TP_STATUS_USER)) break;
+            uint8_t* pkt = reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt;
+            for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++) {
+                auto* hdr = reinterpret_cast<struct tpacket3_hdr*>(pkt);
+                got_data |= deliver(hdr, handler);
+                if (!ring_) return got_data;  // handler 中关闭了 receiver
+                pkt += hdr->tp_next_offset;
+            }
+            status.store(TP_STATUS_KERNEL, std::memory_order_release);
+            block_idx_ = (block_idx_ + 1) % BlockCnt;
+        }
+        return got_data;
+    }
+
+    // 过滤器已经保证是发往 ip:port 的非分片 UDP，这里只做长度检查
+    template <typename Handler>
+    bool deliver(const struct tpacket3_hdr* hdr, Handler& handler) {
+        const uint8_t* frame = reinterpret_cast<const uint8_t*>(hdr);
+        auto* ll = reinterpret_cast<const struct sockaddr_ll*>(frame + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+        if (ll->sll_pkttype == PACKET_OUTGOING) return false;
+        const uint8_t* ip = frame + hdr->tp_net;
+        uint32_t caplen = hdr->tp_snaplen - (hdr->tp_net - hdr->tp_mac);
+        struct iphdr iph;
+        struct udphdr udph;
+        if (caplen < sizeof(iph)) return false;
+        memcpy(&iph, ip, sizeof(iph));
+        uint32_t ihl = iph.ihl * 4;
+        if (caplen < ihl + sizeof(udph)) return false;
+        memcpy(&udph, ip + ihl, sizeof(udph));
+        uint32_t udp_len = ntohs(udph.len);
+        if (udp_len < sizeof(udph)) return false;
+
+        src_addr_.sin_family = AF_INET;
+        src_addr_.sin_addr.s_addr = iph.saddr;
+        src_addr_.sin_port = udph.source;
+        UdpDatagram d = {ip + ihl + sizeof(udph), std::min(udp_len, caplen - ihl) - static_cast<uint32_t>(sizeof(udph)),
+                         &src_addr_};
+        int64_t ts = hdr->tp_sec * 1000000000LL + hdr->tp_nsec;
+        if (hdr->tp_status & TP_STATUS_TS_RAW_HARDWARE)
+            d.ts.hw_ns = ts;
+        else
+            d.ts.sw_ns = ts;
+        handler(d);
+        return true;
+    }
+
     socket_t fd_ = INVALID_SOCKET_FD;
-    uint8_t buf[RecvBufSize];
+    int mcast_fd_ = -1;
+    uint8_t* ring_ = nullptr;
+    uint32_t block_idx_ = 0;
+    struct sockaddr_in src_addr_ = {};
     char last_error_[64] = "";
 };
+#endif
 
-class SocketUdpSender {
+// Stats 为 true 时开启统计，SocketUdpSender 为不带统计的版本
+template <bool Stats = false>
+class BasicSocketUdpSender {
    public:
     bool init(const char* interface_ip, const char* local_ip, uint16_t local_port, const char* dest_ip,
               uint16_t dest_port) {
@@ -605,7 +3205,7 @@ class SocketUdpSender {
         return true;
     }
 
-    ~SocketUdpSender() { close("destruct"); }
+    ~BasicSocketUdpSender() { close("destruct"); }
 
     uint16_t getLocalPort() {
         struct sockaddr_in addr;
@@ -616,6 +3216,9 @@ class SocketUdpSender {
 
     const char* getLastError() { return last_error_; }
 
+    // Stats 为 true 时有效，可以在其他线程调用
+    SocketStats getStats() const { return stats_.snapshot(); }
+
     bool isClosed() { return fd_ == INVALID_SOCKET_FD; }
 
     void close(const char* reason) {
@@ -627,10 +3230,47 @@ class SocketUdpSender {
     }
 
     bool write(const void* data, uint32_t size) {
-        return ::send(fd_, reinterpret_cast<const char*>(data), size, 0) == static_cast<int>(size);
+        bool ok = ::send(fd_, reinterpret_cast<const char*>(data), size, 0) == static_cast<int>(size);
+        recordSend(ok, size, 1);
+        return ok;
     }
 
-   private:
+    // 把 size 字节按 seg_size 切成多个数据报 (最后一个可以更短)，Linux 下用 UDP_SEGMENT 一次发出，
+    // 单次最多 UdpMaxSegments 个分段且不超过 64KB
+    bool writeSegments(const void* data, uint32_t size, uint16_t seg_size) {
+#ifndef _WIN32
+        if (size > seg_size) {
+            char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+            struct iovec iov = {const_cast<void*>(data), size};
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cm), &seg_size, sizeof(seg_size));
+            bool ok = ::sendmsg(fd_, &msg, 0) == static_cast<ssize_t>(size);
+            recordSend(ok, size, (size + seg_size - 1) / seg_size);
+            return ok;
+        }
+        return write(data, size);
+#else
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (uint32_t off = 0; off < size; off += seg_size) {
+            if (!write(p + off, std::min<uint32_t>(seg_size, size - off))) return false;
+        }
+        return true;
+#endif
+    }
+
+    static constexpr uint32_t UdpMaxSegments = 64;
+    static constexpr uint32_t UdpMaxPayload = 65507;
+
+   protected:
     void saveError(const char* msg) {
         int err = get_last_error();
 #ifdef _WIN32
@@ -640,6 +3280,137 @@ class SocketUdpSender {
 #endif
     }
 
+    // 数据报要么整个发出要么没有发出，失败 (含 EAGAIN) 记为一次 partial write
+    void recordSend(bool ok, uint32_t size, uint32_t dgrams) {
+        if (ok)
+            stats_.sent(size, dgrams);
+        else
+            stats_.partialWrite();
+    }
+
     socket_t fd_ = INVALID_SOCKET_FD;
     char last_error_[64] = "";
+    [[no_unique_address]] SocketStatsRecorder<Stats> stats_;
+};
+
+using SocketUdpSender = BasicSocketUdpSender<>;
+
+// 批量发送: queue 暂存数据报，flush 用一次 sendmmsg 发出；setGso(true) 后等长的数据报
+// (最后一个可以更短) 合并成 UDP_SEGMENT 超级包，由内核或网卡切分
+template <uint32_t QueueSize = 64, uint32_t MaxDgramSize = 1500, bool Stats = false>
+class SocketUdpBatchSender : public BasicSocketUdpSender<Stats> {
+    using Base = BasicSocketUdpSender<Stats>;
+    using Base::fd_;
+    using Base::stats_;
+    using Base::UdpMaxPayload;
+    using Base::UdpMaxSegments;
+
+   public:
+    // 队列满时先 flush，仍然放不下时返回 false
+    bool queue(const void* data, uint32_t size) {
+        if (size > MaxDgramSize) return false;
+        if (cnt_ == QueueSize) flush();
+        if (cnt_ == QueueSize) return false;
+        memcpy(buf_ + bytes_, data, size);
+        sizes_[cnt_++] = size;
+        bytes_ += size;
+        stats_.sendQueued(bytes_);
+        return true;
+    }
+
+    uint32_t getQueuedCnt() { return cnt_; }
+
+    void setGso(bool enable) { gso_ = enable; }
+
+    // 返回本次发出的数据报个数，-1 表示出错；发送缓冲满时未发出的数据报留在队列中
+    int flush() {
+        if (cnt_ == 0) return 0;
+        int sent = 0;
+#ifndef _WIN32
+        if (gso_ && cnt_ > 1 && isUniform()) sent = flushGso();
+        if (sent >= 0 && static_cast<uint32_t>(sent) < cnt_) {
+            int n = flushMmsg(sent);
+            if (n < 0 && sent == 0) return -1;
+            if (n > 0) sent += n;
+        }
+#else
+        for (uint32_t off = 0; static_cast<uint32_t>(sent) < cnt_; off += sizes_[sent++]) {
+            if (!this->write(buf_ + off, sizes_[sent])) break;
+        }
+#endif
+        pop(sent);
+        return sent;
+    }
+
+   private:
+#ifndef _WIN32
+    // 空数据报不能作为 GSO 的分段 (分段大小为 0 时无法切分)，交给 sendmmsg 发送
+    bool isUniform() {
+        if (sizes_[0] == 0 || sizes_[cnt_ - 1] == 0) return false;
+        for (uint32_t i = 1; i + 1 < cnt_; i++)
+            if (sizes_[i] != sizes_[0]) return false;
+        return sizes_[cnt_ - 1] <= sizes_[0];
+    }
+
+    // 按 UdpMaxSegments/UdpMaxPayload 分批用 UDP_SEGMENT 发送；内核不支持时关闭 GSO 返回 0 交给 sendmmsg
+    int flushGso() {
+        uint32_t seg = sizes_[0];
+        uint32_t per_send = std::min(UdpMaxSegments, UdpMaxPayload / seg);
+        uint32_t sent = 0;
+        while (sent < cnt_ && per_send > 1) {
+            uint32_t n = std::min(per_send, cnt_ - sent);
+            uint32_t bytes = (n - 1) * seg + sizes_[sent + n - 1];
+            if (!this->writeSegments(buf_ + sent * seg, bytes, seg)) {
+                if (!is_would_block(get_last_error())) gso_ = false;
+                break;
+            }
+            sent += n;
+        }
+        return sent;
+    }
+
+    int flushMmsg(uint32_t first) {
+        struct mmsghdr msgs[QueueSize];
+        struct iovec iovs[QueueSize];
+        uint32_t off = 0;
+        for (uint32_t i = 0; i < first; i++) off += sizes_[i];
+        uint32_t n = cnt_ - first;
+        for (uint32_t i = 0; i < n; i++) {
+            iovs[i].iov_base = buf_ + off;
+            iovs[i].iov_len = sizes_[first + i];
+            off += sizes_[first + i];
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int ret = ::sendmmsg(fd_, msgs, n, 0);
+        if (ret < 0 && is_would_block(get_last_error())) ret = 0;
+        if constexpr (Stats) {
+            if (ret >= 0 && static_cast<uint32_t>(ret) < n) stats_.partialWrite();
+            uint64_t bytes = 0;
+            for (int i = 0; i < ret; i++) bytes += iovs[i].iov_len;
+            if (ret > 0) stats_.sent(bytes, ret);
+        }
+        return ret;
+    }
+#endif
+
+    void pop(uint32_t n) {
+        if (n == cnt_) {
+            cnt_ = bytes_ = 0;
+            return;
+        }
+        uint32_t off = 0;
+        for (uint32_t i = 0; i < n; i++) off += sizes_[i];
+        memmove(buf_, buf_ + off, bytes_ - off);
+        memmove(sizes_, sizes_ + n, (cnt_ - n) * sizeof(sizes_[0]));
+        cnt_ -= n;
+        bytes_ -= off;
+    }
+
+    bool gso_ = false;
+    uint32_t cnt_ = 0;
+    uint32_t bytes_ = 0;
+    uint32_t sizes_[QueueSize];
+    uint8_t buf_[QueueSize * MaxDgramSize];
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <print>
 #include <string>
 
+#include "framing.h"
 #include "socket.h"
 
 struct ClientConf {
@@ -19,6 +20,9 @@ struct MsgHeader {
     uint32_t body_len;
 };
 
+// body_len 超过接收缓冲的帧直接断开连接
+using Dispatcher = FrameDispatcher<LengthPrefixedFraming<MsgHeader, &MsgHeader::body_len>, ClientConf::RecvBufSize>;
+
 class MyClient : public TcpClient {
    private:
     bool is_first = true;
@@ -34,10 +38,10 @@ class MyClient : public TcpClient {
             MsgHeader header;
             std::string msg{"hello"};
             header.body_len = msg.size();
-            this->write(&header, sizeof(MsgHeader));
-            this->write(msg.data(), header.body_len);
-            this->write(&header, sizeof(MsgHeader));
-            this->write(msg.data(), header.body_len);
+            // 两条消息的 header + body 一次 sendmsg 发出
+            struct iovec req[] = {{&header, sizeof(MsgHeader)}, {msg.data(), header.body_len},
+                                  {&header, sizeof(MsgHeader)}, {msg.data(), header.body_len}};
+            this->writev(req);
         }
         is_first = false;
     }
@@ -47,33 +51,14 @@ class MyClient : public TcpClient {
         std::println("recv timeout");
         conn.close("onRecvTimeout");
     }
+    // 不足一帧的半包由 dispatch 返回，pollnet 保留这些字节并在下次数据到达时拼接到 data 开头
     uint32_t onTcpData(TcpClient::Conn& conn, const uint8_t* data, uint32_t size) {
-        while (size >= sizeof(MsgHeader)) {
-            // 1. 解析 Header
-            const auto* header = reinterpret_cast<const MsgHeader*>(data);
-            uint32_t body_len = header->body_len;
-            uint32_t total_len = sizeof(MsgHeader) + body_len;
-
-            // 2. 检查缓冲区是否有完整的 Body
-            if (size < total_len) {
-                // 数据不足一个完整包，跳出循环，返回剩余字节数
-                // pollnet 会保留这些字节并在下次数据到达时拼接到 data 开头
-                break;
-            }
-
-            // 3. 处理 Body (使用 string_view 避免拷贝)
-            std::string_view body{
-                reinterpret_cast<const char*>(data) + sizeof(MsgHeader),
-                body_len};
-
-            std::println("Recv Body [len: {}]: {}", body_len, body);
-
-            // 4. 移动指针，准备处理下一个包
-            data += total_len;
-            size -= total_len;
-        }
-        // 返回值告知 pollnet 缓冲区还剩多少字节没处理（即半包部分）
-        return size;
+        return Dispatcher::dispatch(*this, conn, data, size);
+    }
+    // frame 为完整的一帧 (含 MsgHeader)，使用 string_view 避免拷贝
+    void onFrame(TcpClient::Conn& conn, const uint8_t* frame, uint32_t size) {
+        std::string_view body{reinterpret_cast<const char*>(frame) + sizeof(MsgHeader), size - sizeof(MsgHeader)};
+        std::println("Recv Body [len: {}]: {}", body.size(), body);
     }
 };
 
@@ -83,8 +68,9 @@ int main(int argc, char const* argv[]) {
         std::println("init error:{}", client.getLastError());
         exit(1);
     }
+    SpinBlockIdle idle;
     while (true) {
-        client.poll(client);
+        idle.idle(client.poll(client), client);
     }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <print>
+
+#include "coro.h"
+#include "socket.h"
+
+struct ServerConf {
+    static const uint32_t RecvBufSize = 4096;
+    static const uint32_t MaxConns = 1024;
+    static const uint32_t SendTimeoutSec = 0;
+    static const uint32_t RecvTimeoutSec = 10;
+    static const uint32_t SendBufSize = 1 << 16;
+    // 协程等待状态
+    struct UserData : CoroConnState {};
+};
+
+using TcpServer = SocketTcpServer<ServerConf>;
+
+struct MsgHeader {
+    uint32_t body_len;
+};
+
+// 回复缓冲在协程帧中，限制消息大小使帧不超过 CoroFramePool 分级的上限 (4KB)，会话创建时不 malloc
+const uint32_t MaxBodyLen = 1024;
+
+// 与 tcp_server 相同的协议，把按帧回调改写成每个连接一个顺序执行的会话
+class MyServer : public TcpServer, public CoroHandler<MyServer> {
+   public:
+    void onTcpDisconnect(TcpServer::Conn& conn) {
+        std::println("disconnected: {}", conn.getLastError());
+        CoroHandler::onTcpDisconnect(conn);
+    }
+
+    CoroTask<> onTcpSession(TcpServer::Conn& conn) {
+        std::println("new connection, total={}", getConnCnt());
+        while (true) {
+            auto hdr = co_await readExact(conn, sizeof(MsgHeader));
+            if (hdr.empty()) co_return;
+            MsgHeader rsp_header;
+            memcpy(&rsp_header, hdr.data(), sizeof(rsp_header));
+            if (rsp_header.body_len == 0 || rsp_header.body_len > MaxBodyLen) {
+                conn.close("bad body_len");
+                co_return;
+            }
+            auto body = co_await readExact(conn, rsp_header.body_len);
+            if (body.empty()) co_return;
+            // body 只在下一次 co_await 之前有效，先拷贝出来
+            char rsp[sizeof(MsgHeader) + MaxBodyLen];
+            memcpy(rsp, &rsp_header, sizeof(rsp_header));
+            for (size_t i = 0; i < body.size(); i++) rsp[sizeof(MsgHeader) + i] = static_cast<char>(std::toupper(body[i]));
+            // 以 '.' 开头的请求延迟 100ms 回复，等待期间其他连接照常处理
+            if (body[0] == '.' && !co_await sleep(conn, 100)) co_return;
+            if (!co_await writeAll(conn, rsp, sizeof(MsgHeader) + rsp_header.body_len)) co_return;
+        }
+    }
+};
+
+int main(int argc, char const* argv[]) {
+    auto server = std::make_unique<MyServer>();
+    if (!server->init("", "127.0.0.1", 1234)) {
+        std::println("init failed: {}", server->getLastError());
+        return 1;
+    }
+    SpinBlockIdle idle;
+    while (true) {
+        idle.idle(server->poll(*server), *server);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <print>
+
+#include "framing.h"
+#include "socket.h"
+
+struct ServerConf {
+    static const uint32_t RecvBufSize = 4096;
+    static const uint32_t MaxConns = 1024;
+    static const uint32_t SendTimeoutSec = 0;
+    static const uint32_t RecvTimeoutSec = 10;
+    struct UserData {
+        uint64_t user_id = 0;
+    };
+};
+
+using TcpServer = SocketTcpServer<ServerConf>;
+
+// 二进制协议: 每条消息以 MsgHeader 开头，msg_type 决定消息结构体
+#pragma pack(push, 1)
+struct MsgHeader {
+    uint16_t body_len;
+    uint16_t msg_type;
+};
+
+struct LoginReq {
+    static constexpr uint16_t MsgType = 1;
+    MsgHeader header;
+    uint64_t user_id;
+};
+
+struct OrderReq {
+    static constexpr uint16_t MsgType = 2;
+    MsgHeader header;
+    uint64_t order_id;
+    int64_t price;
+    uint32_t qty;
+};
+
+struct CancelReq {
+    static constexpr uint16_t MsgType = 3;
+    MsgHeader header;
+    uint64_t order_id;
+};
+
+struct Ack {
+    static constexpr uint16_t MsgType = 100;
+    MsgHeader header;
+    uint64_t id;
+};
+#pragma pack(pop)
+
+// msg_type 在编译期生成的跳转表中查到对应的 onMsg，不需要 switch
+using Dispatcher = FrameDispatcher<LengthPrefixedFraming<MsgHeader, &MsgHeader::body_len, &MsgHeader::msg_type>,
+                                   ServerConf::RecvBufSize, LoginReq, OrderReq, CancelReq>;
+
+class MyServer : public TcpServer {
+   public:
+    void onTcpConnected(TcpServer::Conn& conn) { conn.user_id = 0; }
+    void onSendTimeout(TcpServer::Conn& conn) {}
+    void onRecvTimeout(TcpServer::Conn& conn) { conn.close("timeout"); }
+    void onTcpDisconnect(TcpServer::Conn& conn) { std::println("user {} disconnected: {}", conn.user_id, conn.getLastError()); }
+    uint32_t onTcpData(TcpServer::Conn& conn, const uint8_t* data, uint32_t size) {
+        return Dispatcher::dispatch(*this, conn, data, size);
+    }
+
+    // msg 直接指向接收缓冲，帧比结构体短时 dispatch 已经断开连接
+    void onMsg(TcpServer::Conn& conn, const LoginReq& msg) {
+        conn.user_id = msg.user_id;
+        std::println("user {} logged in", conn.user_id);
+        sendAck(conn, msg.user_id);
+    }
+    void onMsg(TcpServer::Conn& conn, const OrderReq& msg) {
+        if (!conn.user_id) {
+            conn.close("order before login");
+            return;
+        }
+        std::println("user {} order {}: {}@{}", conn.user_id, msg.order_id, msg.qty, msg.price);
+        sendAck(conn, msg.order_id);
+    }
+    void onMsg(TcpServer::Conn& conn, const CancelReq& msg) {
+        std::println("user {} cancel {}", conn.user_id, msg.order_id);
+        sendAck(conn, msg.order_id);
+    }
+    // 不定义时未知类型直接断开连接
+    void onUnknownMsg(TcpServer::Conn& conn, const uint8_t* frame, uint32_t size) {
+        std::println("user {} sent unknown msg, size={}", conn.user_id, size);
+    }
+
+   private:
+    void sendAck(TcpServer::Conn& conn, uint64_t id) {
+        Ack ack{{sizeof(Ack) - sizeof(MsgHeader), Ack::MsgType}, id};
+        conn.write(&ack, sizeof(ack));
+    }
+};
+
+int main(int argc, char const* argv[]) {
+    auto server = std::make_unique<MyServer>();
+    if (!server->init("", "127.0.0.1", 1234)) {
+        std::println("init failed: {}", server->getLastError());
+        return 1;
+    }
+    SpinBlockIdle idle;
+    while (true) {
+        idle.idle(server->poll(*server), *server);
+    }
+    return 0;
+}
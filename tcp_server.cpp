@@ -2,6 +2,7 @@
 #include <print>
 #include <string_view>
 
+#include "framing.h"
 #include "socket.h"
 
 struct ServerConf {
@@ -20,6 +21,9 @@ struct MsgHeader {
     uint32_t body_len;
 };
 
+// body_len 超过接收缓冲的帧直接断开连接
+using Dispatcher = FrameDispatcher<LengthPrefixedFraming<MsgHeader, &MsgHeader::body_len>, ServerConf::RecvBufSize>;
+
 std::string upper_and_double(std::string_view sv) {
     std::string out;
     out.reserve(sv.size() * 2);  // 一次分配到位
@@ -57,30 +61,19 @@ class MyServer : public TcpServer {
         exit(1);
     }
     uint32_t onTcpData(TcpServer::Conn& conn, const uint8_t* data, uint32_t size) {
-        while (size >= sizeof(MsgHeader)) {
-            // handle header
-            const auto* req_header = reinterpret_cast<const MsgHeader*>(data);
-            uint32_t req_body_len = req_header->body_len;
-            uint32_t total_len = sizeof(MsgHeader) + req_body_len;
-
-            if (size < total_len) {
-                break;
-            }
-
-            // handle body
-            std::string_view req_body{reinterpret_cast<const char*>(data) + sizeof(MsgHeader), req_body_len};
-
-            std::println("Recv Body [len: {}]: {}", req_body_len, req_body);
-            auto result = upper_and_double(req_body);
-            MsgHeader rsp_header;
-            rsp_header.body_len = result.size();
-            conn.write(&rsp_header, sizeof(MsgHeader));
-            conn.write(result.data(), result.size());
-
-            data += total_len;
-            size -= total_len;
-        }
-        return size;
+        return Dispatcher::dispatch(*this, conn, data, size);
+    }
+    // frame 为完整的一帧 (含 MsgHeader)，直接指向接收缓冲
+    void onFrame(TcpServer::Conn& conn, const uint8_t* frame, uint32_t size) {
+        std::string_view req_body{reinterpret_cast<const char*>(frame) + sizeof(MsgHeader), size - sizeof(MsgHeader)};
+
+        std::println("Recv Body [len: {}]: {}", req_body.size(), req_body);
+        auto result = upper_and_double(req_body);
+        MsgHeader rsp_header;
+        rsp_header.body_len = result.size();
+        // header 和 body 一次 sendmsg 发出
+        struct iovec rsp[] = {{&rsp_header, sizeof(MsgHeader)}, {result.data(), result.size()}};
+        conn.writev(rsp);
     }
     void onRecvTimeout(TcpServer::Conn& conn) {
         std::println("onRecvTimeout");
@@ -97,8 +90,10 @@ int main(int argc, char const* argv[]) {
         std::println("init failed: {}", server.getLastError());
         return 1;
     }
+    // 空闲超过 1000 次 poll 后阻塞在 epoll/poll 上，最多 1ms
+    SpinBlockIdle idle;
     while (true) {
-        server.poll(server);
+        idle.idle(server.poll(server), server);
     }
 
     return 0;
@@ -0,0 +1,49 @@
+#include <cstdint>
+#include <print>
+#include <thread>
+
+#include "sharded_server.h"
+
+struct ServerConf {
+    static const uint32_t RecvBufSize = 4096;
+    static const uint32_t MaxConns = 1024;
+    static const uint32_t SendTimeoutSec = 0;
+    static const uint32_t RecvTimeoutSec = 10;
+    static constexpr PollBackend Backend = PollBackend::EpollLevel;
+    struct UserData {};
+};
+
+using TcpServer = SocketTcpShardedServer<ServerConf>;
+
+// 每个 shard 一个 handler，回调只在各自的线程中发生，不需要加锁
+struct EchoHandler {
+    uint32_t shard;
+
+    void onTcpConnected(TcpServer::Conn& conn) { std::println("[shard {}] new connection", shard); }
+    void onSendTimeout(TcpServer::Conn& conn) {}
+    uint32_t onTcpData(TcpServer::Conn& conn, const uint8_t* data, uint32_t size) {
+        conn.write(data, size);
+        return 0;
+    }
+    void onRecvTimeout(TcpServer::Conn& conn) { conn.close("timeout"); }
+    void onTcpDisconnect(TcpServer::Conn& conn) { std::println("[shard {}] disconnected: {}", shard, conn.getLastError()); }
+};
+
+int main(int argc, char const* argv[]) {
+    const uint32_t shard_cnt = 4;
+    int cpus[shard_cnt] = {0, 1, 2, 3};
+    EchoHandler handlers[shard_cnt] = {{0}, {1}, {2}, {3}};
+
+    auto server = std::make_unique<TcpServer>();
+    if (!server->init("", "127.0.0.1", 1234, shard_cnt, cpus)) {
+        std::println("init failed: {}", server->getLastError());
+        return 1;
+    }
+    server->start([&](uint32_t i) -> EchoHandler& { return handlers[i]; }, SpinBlockIdle());
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        std::println("total connections: {}", server->getConnCnt());
+    }
+
+    return 0;
+}
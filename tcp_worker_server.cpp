@@ -0,0 +1,88 @@
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <print>
+#include <string_view>
+#include <thread>
+
+#include "framing.h"
+#include "socket.h"
+
+struct ServerConf {
+    static const uint32_t RecvBufSize = 4096;
+    static const uint32_t MaxConns = 1024;
+    static const uint32_t SendTimeoutSec = 0;
+    static const uint32_t RecvTimeoutSec = 10;
+    static const uint32_t SendBufSize = 1 << 16;
+    // 工作线程 -> poll 线程的回复队列
+    static const uint32_t ReplyQueueLen = 4096;
+    // 回复与请求一样不超过一帧
+    static const uint32_t ReplyMaxSize = RecvBufSize;
+    struct UserData {};
+};
+
+using TcpServer = SocketTcpServer<ServerConf>;
+
+struct MsgHeader {
+    uint32_t body_len;
+};
+
+using Dispatcher = FrameDispatcher<LengthPrefixedFraming<MsgHeader, &MsgHeader::body_len>, ServerConf::RecvBufSize>;
+
+// poll 线程 -> 各工作线程，每个工作线程一个 SPSC 队列
+const uint32_t WorkerCnt = 2;
+using WorkQueue = SpscMsgQueue<ServerConf::RecvBufSize, 1024>;
+
+class MyServer : public TcpServer {
+   public:
+    WorkQueue queues[WorkerCnt];
+
+    void onTcpConnected(TcpServer::Conn& conn) { std::println("new connection, total={}", getConnCnt()); }
+    void onSendTimeout(TcpServer::Conn& conn) {}
+    void onRecvTimeout(TcpServer::Conn& conn) { conn.close("timeout"); }
+    void onTcpDisconnect(TcpServer::Conn& conn) { std::println("disconnected: {}", conn.getLastError()); }
+    uint32_t onTcpData(TcpServer::Conn& conn, const uint8_t* data, uint32_t size) {
+        return Dispatcher::dispatch(*this, conn, data, size);
+    }
+    // poll 线程只分帧和转交，同一连接的消息总是交给同一个工作线程，回复保持顺序
+    void onFrame(TcpServer::Conn& conn, const uint8_t* frame, uint32_t size) {
+        ConnHandle h = getHandle(conn);
+        if (!queues[h.idx % WorkerCnt].push(h, frame, size)) conn.close("worker queue full");
+    }
+};
+
+// 耗时的处理在工作线程中完成，结果通过 reply 交回 poll 线程发送
+void worker(MyServer& server, WorkQueue& queue, std::atomic<bool>& running) {
+    SpinYieldIdle idle;
+    while (running.load(std::memory_order_relaxed)) {
+        uint32_t n = queue.poll([&](ConnHandle h, const uint8_t* frame, uint32_t size) {
+            std::string_view body{reinterpret_cast<const char*>(frame) + sizeof(MsgHeader), size - sizeof(MsgHeader)};
+            char rsp[ServerConf::ReplyMaxSize];
+            MsgHeader rsp_header{static_cast<uint32_t>(body.size())};
+            memcpy(rsp, &rsp_header, sizeof(rsp_header));
+            for (size_t i = 0; i < body.size(); i++) rsp[sizeof(MsgHeader) + i] = static_cast<char>(std::toupper(body[i]));
+            // 回复队列满时重试，连接已断开的回复由 poll 线程丢弃
+            while (!server.reply(h, rsp, sizeof(MsgHeader) + body.size())) std::this_thread::yield();
+        });
+        idle.idle(n > 0, queue);
+    }
+}
+
+int main(int argc, char const* argv[]) {
+    auto server = std::make_unique<MyServer>();
+    if (!server->init("", "127.0.0.1", 1234)) {
+        std::println("init failed: {}", server->getLastError());
+        return 1;
+    }
+    std::atomic<bool> running{true};
+    std::thread workers[WorkerCnt];
+    for (uint32_t i = 0; i < WorkerCnt; i++) workers[i] = std::thread(worker, std::ref(*server), std::ref(server->queues[i]), std::ref(running));
+
+    SpinIdle idle;
+    while (true) {
+        idle.idle(server->poll(*server), *server);
+    }
+    running = false;
+    for (auto& t : workers) t.join();
+    return 0;
+}
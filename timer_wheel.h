@@ -0,0 +1,143 @@
+#pragma once
+
+// ==========================================
+// 分层时间轮 (Hierarchical Timing Wheel)
+// ==========================================
+// 4 层，每层 256 个槽，tick 为 1ms，可表示约 49 天之内的定时器；更远的定时器挂在最高层，降级时重新计算。
+// 定时器节点侵入式地嵌在使用者的结构中，arm/cancel 都是 O(1)，advance 只处理走过的 tick 对应的槽。
+// 非线程安全，与所属的 server/client 在同一个 poll 线程中使用。
+
+#include <algorithm>
+#include <cstdint>
+
+struct TimerNode {
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    int64_t expire_tick = 0;
+    // 由使用者解释: 定时器种类和关联对象
+    uint32_t kind = 0;
+    void* ptr = nullptr;
+
+    bool isArmed() const { return next != nullptr; }
+};
+
+class TimerWheel {
+   public:
+    static constexpr int64_t TickNs = 1000000;
+    static constexpr uint32_t SlotBits = 8;
+    static constexpr uint32_t Slots = 1u << SlotBits;
+    static constexpr uint32_t Levels = 4;
+
+    TimerWheel() {
+        for (uint32_t l = 0; l < Levels; l++)
+            for (uint32_t i = 0; i < Slots; i++) slots_[l][i].prev = slots_[l][i].next = &slots_[l][i];
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 上一次 advance 的时间，写操作等不读时钟的地方以此作为当前时间
+    int64_t now() const { return now_; }
+
+    // 到期时间向上取整到 tick，保证不会提前触发；已经过期的在下一次 advance 触发
+    void arm(TimerNode& node, int64_t expire_ns) {
+        if (node.isArmed()) unlink(node);
+        node.expire_tick = (expire_ns + TickNs - 1) / TickNs;
+        insert(node, cur_tick_ + 1);
+    }
+
+    void cancel(TimerNode& node) {
+        if (node.isArmed()) unlink(node);
+    }
+
+    // 逐 tick 推进到 now_ns，对每个到期节点调用 on_expire(node)，回调中可以再次 arm/cancel 任意节点
+    template <typename OnExpire>
+    void advance(int64_t now_ns, OnExpire on_expire) {
+        now_ = now_ns;
+        int64_t target = now_ns / TickNs;
+        if (!started_) {
+            // 第一次 advance 之前 arm 的节点是相对 tick 0 放置的，按真实的当前 tick 重新放置
+            started_ = true;
+            cur_tick_ = target;
+            TimerNode pending;
+            pending.prev = pending.next = &pending;
+            for (uint32_t l = 0; l < Levels; l++)
+                for (uint32_t i = 0; i < Slots; i++) moveAll(slots_[l][i], pending);
+            while (pending.next != &pending) {
+                TimerNode& node = *pending.next;
+                unlink(node);
+                insert(node, cur_tick_ + 1);
+            }
+            return;
+        }
+        while (cur_tick_ < target) {
+            cur_tick_++;
+            // 低层转完一圈时，把上一层对应槽中的节点降级 (高层先降)
+            for (uint32_t l = Levels - 1; l > 0; l--) {
+                if ((cur_tick_ & ((int64_t{1} << (SlotBits * l)) - 1)) == 0) cascade(l);
+            }
+            TimerNode& head = slots_[0][cur_tick_ & (Slots - 1)];
+            if (head.next == &head) continue;
+            // 先把整个槽摘到局部链表，回调中重新 arm 到同一个槽的节点不会在本轮再次触发
+            TimerNode expired;
+            expired.prev = expired.next = &expired;
+            moveAll(head, expired);
+            while (expired.next != &expired) {
+                TimerNode& node = *expired.next;
+                unlink(node);
+                on_expire(node);
+            }
+        }
+    }
+
+   private:
+    // min_tick: arm 时为下一个 tick；降级时为当前 tick，此时落在本 tick 的节点紧接着就会被处理
+    void insert(TimerNode& node, int64_t min_tick) {
+        int64_t tick = std::max(node.expire_tick, min_tick);
+        int64_t delta = tick - cur_tick_;
+        uint32_t level = 0;
+        while (level < Levels - 1 && delta >= (int64_t{1} << (SlotBits * (level + 1)))) level++;
+        if (delta >= (int64_t{1} << (SlotBits * Levels))) tick = cur_tick_ + (int64_t{1} << (SlotBits * Levels)) - 1;
+        link(slots_[level][(tick >> (SlotBits * level)) & (Slots - 1)], node);
+    }
+
+    static void link(TimerNode& head, TimerNode& node) {
+        node.prev = head.prev;
+        node.next = &head;
+        head.prev->next = &node;
+        head.prev = &node;
+    }
+
+    static void unlink(TimerNode& node) {
+        node.prev->next = node.next;
+        node.next->prev = node.prev;
+        node.prev = node.next = nullptr;
+    }
+
+    // 把 head 链表中的节点整体接到 dst 末尾
+    static void moveAll(TimerNode& head, TimerNode& dst) {
+        if (head.next == &head) return;
+        head.next->prev = dst.prev;
+        dst.prev->next = head.next;
+        head.prev->next = &dst;
+        dst.prev = head.prev;
+        head.prev = head.next = &head;
+    }
+
+    void cascade(uint32_t level) {
+        TimerNode& head = slots_[level][(cur_tick_ >> (SlotBits * level)) & (Slots - 1)];
+        TimerNode pending;
+        pending.prev = pending.next = &pending;
+        moveAll(head, pending);
+        while (pending.next != &pending) {
+            TimerNode& node = *pending.next;
+            unlink(node);
+            insert(node, cur_tick_);
+        }
+    }
+
+    int64_t now_ = 0;
+    int64_t cur_tick_ = 0;
+    bool started_ = false;
+    TimerNode slots_[Levels][Slots];
+};
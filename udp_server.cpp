@@ -17,8 +17,9 @@ int main(int argc, char const* argv[]) {
         return 1;
     }
 
+    SpinBlockIdle idle;
     while (true) {
-        server.recvfrom([](const uint8_t* data, uint32_t size, auto addr) {
+        bool got = server.recvfrom([](const uint8_t* data, uint32_t size, auto addr) {
             // 1. 直接打印收到的原始数据 dat
             for (auto b : std::span(data, size)) {
                 std::print("{:02x} ", b);
@@ -35,5 +36,6 @@ int main(int argc, char const* argv[]) {
             auto body = std::string_view(body_ptr, body_len);
             std::println("recv {}, type={}, seq={}", body, req_header->type, req_header->seq);
         });
+        idle.idle(got, server);
     }
 }
\ No newline at end of file
@@ -0,0 +1,233 @@
+#pragma once
+
+// ==========================================
+// 极简 io_uring 封装 (仅 Linux，不依赖 liburing)
+// ==========================================
+// 只实现 pollnet 需要的部分: SQ/CQ 映射、稀疏注册文件表、单个 provided buffer ring。
+// 非线程安全，一个 IoUring 只能被一个 poll 线程使用。
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+class IoUring {
+   public:
+    ~IoUring() { close(); }
+
+    // entries: SQ 大小，cq_entries: CQ 大小 (multishot 会产生大量 CQE，应比 SQ 大)
+    bool init(uint32_t entries, uint32_t cq_entries) {
+        struct io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        p.flags = IORING_SETUP_CQSIZE;
+        p.cq_entries = cq_entries;
+        int fd = syscall(__NR_io_uring_setup, entries, &p);
+        if (fd < 0) return false;
+        ring_fd_ = fd;
+
+        sq_map_size_ = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+        cq_map_size_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+
+        sq_map_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_map_ == MAP_FAILED) {
+            sq_map_ = nullptr;
+            close();
+            return false;
+        }
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_map_ = sq_map_;
+        } else {
+            cq_map_ = mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_map_ == MAP_FAILED) {
+                cq_map_ = nullptr;
+                close();
+                return false;
+            }
+        }
+        sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = static_cast<struct io_uring_sqe*>(
+            mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) {
+            sqes_ = nullptr;
+            close();
+            return false;
+        }
+
+        uint8_t* sq = static_cast<uint8_t*>(sq_map_);
+        sq_head_ = reinterpret_cast<uint32_t*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<uint32_t*>(sq + p.sq_off.tail);
+        sq_flags_ = reinterpret_cast<uint32_t*>(sq + p.sq_off.flags);
+        sq_array_ = reinterpret_cast<uint32_t*>(sq + p.sq_off.array);
+        sq_mask_ = *reinterpret_cast<uint32_t*>(sq + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        sq_local_tail_ = *sq_tail_;
+
+        uint8_t* cq = static_cast<uint8_t*>(cq_map_);
+        cq_head_ = reinterpret_cast<uint32_t*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<uint32_t*>(cq + p.cq_off.tail);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+        cq_mask_ = *reinterpret_cast<uint32_t*>(cq + p.cq_off.ring_mask);
+        return true;
+    }
+
+    void close() {
+        if (buf_ring_) munmap(buf_ring_, buf_ring_size_);
+        if (sqes_) munmap(sqes_, sqes_size_);
+        if (cq_map_ && cq_map_ != sq_map_) munmap(cq_map_, cq_map_size_);
+        if (sq_map_) munmap(sq_map_, sq_map_size_);
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+        buf_ring_ = nullptr;
+        sqes_ = nullptr;
+        sq_map_ = cq_map_ = nullptr;
+        ring_fd_ = -1;
+        pending_ = 0;
+    }
+
+    bool isOpen() { return ring_fd_ >= 0; }
+
+    // ring fd 在 CQ 非空时可读，可用于 poll/epoll 阻塞等待完成事件
+    int getFd() { return ring_fd_; }
+
+    // SQ 满时先提交再取
+    struct io_uring_sqe* getSqe() {
+        uint32_t head = std::atomic_ref<uint32_t>(*sq_head_).load(std::memory_order_acquire);
+        if (sq_local_tail_ - head >= sq_entries_) {
+            submit();
+            head = std::atomic_ref<uint32_t>(*sq_head_).load(std::memory_order_acquire);
+            if (sq_local_tail_ - head >= sq_entries_) return nullptr;
+        }
+        uint32_t idx = sq_local_tail_ & sq_mask_;
+        struct io_uring_sqe* sqe = &sqes_[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        sq_local_tail_++;
+        pending_++;
+        return sqe;
+    }
+
+    // 没有待提交 SQE 且 CQ 未溢出时不进入内核，CQE 直接从共享内存读取
+    int submit() {
+        bool overflow = std::atomic_ref<uint32_t>(*sq_flags_).load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW;
+        if (!pending_ && !overflow) return 0;
+        std::atomic_ref<uint32_t>(*sq_tail_).store(sq_local_tail_, std::memory_order_release);
+        int ret = syscall(__NR_io_uring_enter, ring_fd_, pending_, 0, overflow ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (ret > 0) pending_ -= std::min<uint32_t>(pending_, ret);
+        return ret;
+    }
+
+    // 遍历所有已完成的 CQE，返回处理的数量
+    template <typename Handler>
+    uint32_t forEachCqe(Handler handler) {
+        uint32_t head = *cq_head_;
+        uint32_t tail = std::atomic_ref<uint32_t>(*cq_tail_).load(std::memory_order_acquire);
+        uint32_t cnt = tail - head;
+        for (; head != tail; head++) {
+            handler(cqes_[head & cq_mask_]);
+            // handler 中可能提交新的 SQE，CQE 槽位在推进 head 之前一直有效
+        }
+        std::atomic_ref<uint32_t>(*cq_head_).store(head, std::memory_order_release);
+        return cnt;
+    }
+
+    // 注册 n 个空槽位的稀疏文件表，之后用 updateFile 填充
+    bool registerFiles(uint32_t n) {
+        struct io_uring_rsrc_register reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.nr = n;
+        reg.flags = IORING_RSRC_REGISTER_SPARSE;
+        return syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_FILES2, &reg, sizeof(reg)) == 0;
+    }
+
+    // fd = -1 清空槽位
+    bool updateFile(uint32_t idx, int fd) {
+        struct io_uring_files_update up;
+        memset(&up, 0, sizeof(up));
+        up.offset = idx;
+        up.fds = reinterpret_cast<uint64_t>(&fd);
+        return syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_FILES_UPDATE, &up, 1) == 1;
+    }
+
+    // 注册 buffer group 0，buf_cnt 必须是 2 的幂，base 指向 buf_cnt * buf_size 字节
+    bool setupBufRing(uint8_t* base, uint32_t buf_cnt, uint32_t buf_size) {
+        buf_ring_size_ = buf_cnt * sizeof(struct io_uring_buf);
+        void* p = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return false;
+        buf_ring_ = static_cast<struct io_uring_buf_ring*>(p);
+
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+        reg.ring_entries = buf_cnt;
+        reg.bgid = 0;
+        if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            munmap(buf_ring_, buf_ring_size_);
+            buf_ring_ = nullptr;
+            return false;
+        }
+        buf_base_ = base;
+        buf_size_ = buf_size;
+        buf_mask_ = buf_cnt - 1;
+        buf_tail_ = 0;
+        for (uint32_t i = 0; i < buf_cnt; i++) addBuf(i);
+        commitBufs();
+        return true;
+    }
+
+    uint8_t* getBuf(uint16_t bid) { return buf_base_ + static_cast<size_t>(bid) * buf_size_; }
+
+    // 把用完的 buffer 还给内核，多个 recycle 之后调用一次 commitBufs
+    void recycleBuf(uint16_t bid) { addBuf(bid); }
+
+    void commitBufs() { std::atomic_ref<uint16_t>(buf_ring_->tail).store(buf_tail_, std::memory_order_release); }
+
+    static bool hasBuf(const struct io_uring_cqe& cqe) { return cqe.flags & IORING_CQE_F_BUFFER; }
+    static uint16_t bufId(const struct io_uring_cqe& cqe) { return cqe.flags >> IORING_CQE_BUFFER_SHIFT; }
+    static bool hasMore(const struct io_uring_cqe& cqe) { return cqe.flags & IORING_CQE_F_MORE; }
+
+   private:
+    void addBuf(uint16_t bid) {
+        // C++ 下 __DECLARE_FLEX_ARRAY 的空 struct 占 1 字节，bufs 会偏移 8 字节，这里手动索引
+        struct io_uring_buf& buf = reinterpret_cast<struct io_uring_buf*>(buf_ring_)[buf_tail_ & buf_mask_];
+        buf.addr = reinterpret_cast<uint64_t>(getBuf(bid));
+        buf.len = buf_size_;
+        buf.bid = bid;
+        buf_tail_++;
+    }
+
+    int ring_fd_ = -1;
+    uint32_t pending_ = 0;
+
+    void* sq_map_ = nullptr;
+    void* cq_map_ = nullptr;
+    size_t sq_map_size_ = 0;
+    size_t cq_map_size_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    uint32_t* sq_head_ = nullptr;
+    uint32_t* sq_tail_ = nullptr;
+    uint32_t* sq_flags_ = nullptr;
+    uint32_t* sq_array_ = nullptr;
+    uint32_t sq_mask_ = 0;
+    uint32_t sq_entries_ = 0;
+    uint32_t sq_local_tail_ = 0;
+
+    uint32_t* cq_head_ = nullptr;
+    uint32_t* cq_tail_ = nullptr;
+    struct io_uring_cqe* cqes_ = nullptr;
+    uint32_t cq_mask_ = 0;
+
+    struct io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_size_ = 0;
+    uint8_t* buf_base_ = nullptr;
+    uint32_t buf_size_ = 0;
+    uint32_t buf_mask_ = 0;
+    uint16_t buf_tail_ = 0;
+};